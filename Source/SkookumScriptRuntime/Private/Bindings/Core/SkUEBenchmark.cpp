@@ -0,0 +1,356 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Bindings for the Benchmark class of the Core-Test overlay
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEBenchmark.hpp"
+#include "ISkookumScriptRuntime.h"
+#include "Bindings/SkUEMemberLookup.hpp"
+#include "Bindings/SkUEUtils.hpp"
+
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+
+#include <SkookumScript/SkBoolean.hpp>
+#include <SkookumScript/SkBrain.hpp>
+#include <SkookumScript/SkClosure.hpp>
+#include <SkookumScript/SkInteger.hpp>
+#include <SkookumScript/SkInvokedMethod.hpp>
+#include <SkookumScript/SkString.hpp>
+
+//=======================================================================================
+// Method Definitions
+//=======================================================================================
+
+namespace SkUEBenchmark_Impl
+  {
+
+  //---------------------------------------------------------------------------------------
+  // Return one line summary of a benchmark result
+  static void return_summary(const SkUEBenchmark::Result & result, SkInstance ** result_pp)
+    {
+    if (result_pp)
+      {
+      FString summary = FString::Printf(TEXT("%s: median %.1f ns, p99 %.1f ns per op"), *result.m_name, result.m_median_ns, result.m_p99_ns);
+      *result_pp = SkString::new_instance(FStringToAString(summary));
+      }
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   Benchmark@run(String name, Integer warmup, Integer samples, Integer ops_per_sample, () code) String
+  static void mthdc_run(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    FString     name           = AStringToFString(scope_p->get_arg<SkString>(SkArg_1));
+    int32       warmup         = scope_p->get_arg<SkInteger>(SkArg_2);
+    int32       samples        = scope_p->get_arg<SkInteger>(SkArg_3);
+    int32       ops_per_sample = FMath::Max(scope_p->get_arg<SkInteger>(SkArg_4), 1);
+    SkClosure * closure_p      = scope_p->get_arg_data<SkClosure>(SkArg_5);
+    SkInstance ** no_args_pp   = nullptr;
+
+    // Warm up pools, caches and memoized lookups before anything is measured
+    for (int32 op = 0; op < warmup * ops_per_sample; ++op)
+      {
+      closure_p->closure_method_call(no_args_pp, 0u, nullptr, scope_p);
+      }
+
+    SkUEBenchmark::begin(name, ops_per_sample);
+    for (int32 sample = 0; sample < samples; ++sample)
+      {
+      SkUEBenchmark::sample_begin();
+      for (int32 op = 0; op < ops_per_sample; ++op)
+        {
+        closure_p->closure_method_call(no_args_pp, 0u, nullptr, scope_p);
+        }
+      SkUEBenchmark::sample_end();
+      }
+
+    return_summary(SkUEBenchmark::end(), result_pp);
+    }
+
+  //---------------------------------------------------------------------------------------
+  // Times `samples` samples of `ops_per_sample` engine side calls by name of an immediate
+  // coroutine - either with the runtime lookup or with the memoized one
+  static const SkUEBenchmark::Result & run_coroutine_call(const FString & name, SkInstance * receiver_p, const ASymbol & coroutine_name, int32 warmup, int32 samples, int32 ops_per_sample, bool is_memoized)
+    {
+    for (int32 sample = -warmup; sample < samples; ++sample)
+      {
+      if (sample == 0)
+        {
+        SkUEBenchmark::begin(name, ops_per_sample);
+        }
+      if (sample >= 0)
+        {
+        SkUEBenchmark::sample_begin();
+        }
+      for (int32 op = 0; op < ops_per_sample; ++op)
+        {
+        if (is_memoized)
+          {
+          SkUEMemberLookup::coroutine_call(receiver_p, coroutine_name);
+          }
+        else
+          {
+          receiver_p->coroutine_call(coroutine_name);
+          }
+        }
+      if (sample >= 0)
+        {
+        SkUEBenchmark::sample_end();
+        }
+      }
+
+    return SkUEBenchmark::end();
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   Benchmark@run_coroutine_call(Object receiver, String coroutine_name, Integer warmup, Integer samples, Integer ops_per_sample) String
+  static void mthdc_run_coroutine_call(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkInstance * receiver_p     = scope_p->get_arg(SkArg_1);
+    ASymbol      coroutine_name = ASymbol::create(scope_p->get_arg<SkString>(SkArg_2));
+    int32        warmup         = scope_p->get_arg<SkInteger>(SkArg_3);
+    int32        samples        = scope_p->get_arg<SkInteger>(SkArg_4);
+    int32        ops_per_sample = FMath::Max(scope_p->get_arg<SkInteger>(SkArg_5), 1);
+
+    run_coroutine_call(TEXT("coroutine_call_by_name"), receiver_p, coroutine_name, warmup, samples, ops_per_sample, false);
+    return_summary(
+      run_coroutine_call(TEXT("coroutine_call_by_name_memo"), receiver_p, coroutine_name, warmup, samples, ops_per_sample, true),
+      result_pp);
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   Benchmark@begin(String name, Integer ops_per_sample)
+  static void mthdc_begin(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkUEBenchmark::begin(AStringToFString(scope_p->get_arg<SkString>(SkArg_1)), scope_p->get_arg<SkInteger>(SkArg_2));
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   Benchmark@sample_begin()
+  static void mthdc_sample_begin(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkUEBenchmark::sample_begin();
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   Benchmark@sample_end()
+  static void mthdc_sample_end(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkUEBenchmark::sample_end();
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   Benchmark@end() String
+  static void mthdc_end(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    return_summary(SkUEBenchmark::end(), result_pp);
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   Benchmark@reset()
+  static void mthdc_reset(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkUEBenchmark::reset();
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   Benchmark@export(String path) Boolean
+  static void mthdc_export(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    FString path = AStringToFString(scope_p->get_arg<SkString>(SkArg_1));
+    if (path.IsEmpty())
+      {
+      path = SkUEBenchmark::get_export_path();
+      }
+
+    bool success = SkUEBenchmark::export_json(path);
+    if (success)
+      {
+      UE_LOG(LogSkookum, Display, TEXT("Wrote SkookumScript benchmark results to '%s'."), *path);
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Unable to write SkookumScript benchmark results to '%s'."), *path);
+      }
+
+    if (result_pp)
+      {
+      *result_pp = SkBoolean::new_instance(success);
+      }
+    }
+
+  static const SkClass::MethodInitializerFunc methods_c[] =
+    {
+      { "run",                mthdc_run },
+      { "run_coroutine_call", mthdc_run_coroutine_call },
+      { "begin",              mthdc_begin },
+      { "sample_begin",       mthdc_sample_begin },
+      { "sample_end",         mthdc_sample_end },
+      { "end",                mthdc_end },
+      { "reset",              mthdc_reset },
+      { "export",             mthdc_export },
+    };
+
+  } // SkUEBenchmark_Impl
+
+//=======================================================================================
+// SkUEBenchmark Class Data
+//=======================================================================================
+
+FString                        SkUEBenchmark::ms_name;
+int32                          SkUEBenchmark::ms_ops_per_sample = 1;
+uint64                         SkUEBenchmark::ms_sample_start;
+TArray<uint64>                 SkUEBenchmark::ms_sample_cycles;
+TArray<SkUEBenchmark::Result>  SkUEBenchmark::ms_results;
+
+//=======================================================================================
+// SkUEBenchmark Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+
+void SkUEBenchmark::register_bindings()
+  {
+  SkClass * class_p = SkBrain::get_class("Benchmark");
+  if (class_p)
+    {
+    class_p->register_method_func_bulk(SkUEBenchmark_Impl::methods_c, A_COUNT_OF(SkUEBenchmark_Impl::methods_c), SkBindFlag_class_no_rebind);
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Starts collecting samples for a new benchmark
+
+void SkUEBenchmark::begin(const FString & name, int32 ops_per_sample)
+  {
+  ms_name           = name;
+  ms_ops_per_sample = FMath::Max(ops_per_sample, 1);
+  ms_sample_cycles.Reset();
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEBenchmark::sample_begin()
+  {
+  ms_sample_start = FPlatformTime::Cycles64();
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEBenchmark::sample_end()
+  {
+  ms_sample_cycles.Add(FPlatformTime::Cycles64() - ms_sample_start);
+  }
+
+//---------------------------------------------------------------------------------------
+// Reduces the samples of the current benchmark to ns per operation statistics and adds
+// them to the results
+
+const SkUEBenchmark::Result & SkUEBenchmark::end()
+  {
+  double ns_per_cycle = FPlatformTime::GetSecondsPerCycle64() * 1.0e9 / double(ms_ops_per_sample);
+
+  TArray<double> sample_ns;
+  sample_ns.Reserve(ms_sample_cycles.Num());
+  double total_ns = 0.0;
+  for (uint64 cycles : ms_sample_cycles)
+    {
+    double ns = double(cycles) * ns_per_cycle;
+    sample_ns.Add(ns);
+    total_ns += ns;
+    }
+  sample_ns.Sort();
+
+  Result & result = ms_results[ms_results.AddZeroed()];
+  result.m_name           = ms_name;
+  result.m_ops_per_sample = ms_ops_per_sample;
+  result.m_samples        = sample_ns.Num();
+  if (sample_ns.Num())
+    {
+    int32 count = sample_ns.Num();
+    result.m_median_ns = sample_ns[count / 2];
+    result.m_p99_ns    = sample_ns[FMath::Clamp(FMath::CeilToInt(count * 0.99) - 1, 0, count - 1)];
+    result.m_mean_ns   = total_ns / count;
+    result.m_min_ns    = sample_ns[0];
+    }
+
+  UE_LOG(LogSkookum, Display, TEXT("Benchmark %s: median %.1f ns, p99 %.1f ns, mean %.1f ns, min %.1f ns per op (%d samples of %d ops)"),
+    *result.m_name, result.m_median_ns, result.m_p99_ns, result.m_mean_ns, result.m_min_ns, result.m_samples, result.m_ops_per_sample);
+
+  ms_sample_cycles.Reset();
+  return result;
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEBenchmark::reset()
+  {
+  ms_name.Empty();
+  ms_ops_per_sample = 1;
+  ms_sample_cycles.Empty();
+  ms_results.Empty();
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes all results as JSON - one object per benchmark
+
+bool SkUEBenchmark::export_json(const FString & path)
+  {
+  FString json;
+  TSharedRef<TJsonWriter<>> writer_p = TJsonWriterFactory<>::Create(&json);
+  writer_p->WriteObjectStart();
+  writer_p->WriteValue(TEXT("build"), FString(FApp::GetBuildVersion()));
+  writer_p->WriteValue(TEXT("configuration"), FString(EBuildConfigurations::ToString(FApp::GetBuildConfiguration())));
+  writer_p->WriteValue(TEXT("time"), FDateTime::UtcNow().ToIso8601());
+  writer_p->WriteArrayStart(TEXT("results"));
+  for (const Result & result : ms_results)
+    {
+    writer_p->WriteObjectStart();
+    writer_p->WriteValue(TEXT("name"), result.m_name);
+    writer_p->WriteValue(TEXT("ops_per_sample"), result.m_ops_per_sample);
+    writer_p->WriteValue(TEXT("samples"), result.m_samples);
+    writer_p->WriteValue(TEXT("median_ns"), result.m_median_ns);
+    writer_p->WriteValue(TEXT("p99_ns"), result.m_p99_ns);
+    writer_p->WriteValue(TEXT("mean_ns"), result.m_mean_ns);
+    writer_p->WriteValue(TEXT("min_ns"), result.m_min_ns);
+    writer_p->WriteObjectEnd();
+    }
+  writer_p->WriteArrayEnd();
+  writer_p->WriteObjectEnd();
+  writer_p->Close();
+
+  return FFileHelper::SaveStringToFile(json, *path);
+  }
+
+//---------------------------------------------------------------------------------------
+
+FString SkUEBenchmark::get_export_path()
+  {
+  return FPaths::ProfilingDir() / TEXT("SkookumScript") / (TEXT("Benchmark-") + FDateTime::Now().ToString() + TEXT(".json"));
+  }
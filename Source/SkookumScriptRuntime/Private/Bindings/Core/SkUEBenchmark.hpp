@@ -0,0 +1,88 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Bindings for the Benchmark class of the Core-Test overlay
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Timing harness for script micro-benchmarks. `Benchmark.run()` calls an immediate
+// closure for a number of warmup samples and then times each measured sample of
+// `ops_per_sample` calls. Durational code is timed with `Benchmark.begin()`,
+// `sample_begin()`, `sample_end()` and `end()` instead. Each benchmark reports the
+// median, p99, mean and min ns per operation, and `Benchmark.export()` writes all results
+// as JSON so runs can be compared across commits.
+//
+// The Benchmark class only exists when the Core-Test overlay is compiled in - the
+// bindings are skipped otherwise.
+class SkUEBenchmark
+  {
+  public:
+
+  // Public Structures
+
+    struct Result
+      {
+      FString m_name;
+      int32   m_ops_per_sample;
+      int32   m_samples;
+      double  m_median_ns;
+      double  m_p99_ns;
+      double  m_mean_ns;
+      double  m_min_ns;
+      };
+
+  // Class Methods
+
+    static void register_bindings();
+
+    static void begin(const FString & name, int32 ops_per_sample);
+    static void sample_begin();
+    static void sample_end();
+    static const Result & end();
+    static void reset();
+
+    static const TArray<Result> & get_results()    { return ms_results; }
+    static bool export_json(const FString & path);
+    static FString get_export_path();
+
+  protected:
+
+  // Class Data Members
+
+    static FString        ms_name;
+    static int32          ms_ops_per_sample;
+    static uint64         ms_sample_start;
+    static TArray<uint64> ms_sample_cycles;
+
+    static TArray<Result> ms_results;
+
+  };  // SkUEBenchmark
@@ -0,0 +1,308 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Additional bindings for the List class
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEList.hpp"
+
+#include <SkookumScript/SkBoolean.hpp>
+#include <SkookumScript/SkBrain.hpp>
+#include <SkookumScript/SkClosure.hpp>
+#include <SkookumScript/SkDebug.hpp>
+#include <SkookumScript/SkInteger.hpp>
+#include <SkookumScript/SkInvokedMethod.hpp>
+
+//=======================================================================================
+// Method Definitions
+//=======================================================================================
+
+namespace SkUEList_Impl
+  {
+
+  //---------------------------------------------------------------------------------------
+  // Invocation frame for calling the same immediate closure once per list item.
+  // SkClosure::closure_method_call() sets up and tears down a whole invoked method
+  // context for every call - here the invoked method and its data array are set up once
+  // by with_closure_frame() and each call only rebinds the arguments and captured
+  // variables. Emptying the data after each call also releases any locals so the next
+  // item starts with a clean frame.
+  class ClosureFrame
+    {
+    public:
+
+      ClosureFrame(SkInvokedMethod * imethod_p, SkClosure * closure_p, SkInvokedBase * caller_p)
+        : m_imethod_p(imethod_p)
+        , m_closure_p(closure_p)
+        , m_info_p(static_cast<SkClosureInfoMethod *>(closure_p->get_info()))
+        , m_caller_p(caller_p)
+        {}
+
+      //---------------------------------------------------------------------------------------
+      // Call closure - args_pp must already be referenced and the references are consumed
+      void call(SkInstance ** args_pp, uint32_t arg_count, SkInstance ** result_pp = nullptr)
+        {
+        m_imethod_p->data_append_args(args_pp, arg_count, m_info_p->get_params());
+        m_imethod_p->data_append_vars_ref(m_closure_p->get_captured_array(), m_closure_p->get_captured_count());
+        m_info_p->SkMethod::invoke(m_imethod_p, m_caller_p, result_pp); // We know it's a method so call directly
+        m_imethod_p->data_empty();
+        }
+
+      //---------------------------------------------------------------------------------------
+      // Call closure with a single item and return its Boolean result
+      bool query(SkInstance * item_p)
+        {
+        SkInstance * result_p = SkBrain::ms_nil_p;
+        item_p->reference();
+        call(&item_p, 1u, &result_p);
+        bool result = result_p->as<SkBoolean>();
+        result_p->dereference();
+        return result;
+        }
+
+    protected:
+
+      SkInvokedMethod *     m_imethod_p;
+      SkClosure *           m_closure_p;
+      SkClosureInfoMethod * m_info_p;
+      SkInvokedBase *       m_caller_p;
+    };
+
+  //---------------------------------------------------------------------------------------
+  // Set up a frame for the closure passed as first argument and hand it to `iterator`
+  // Arg iterator - Lambda with the signature (ClosureFrame & frame)
+  template<typename _LambdaType>
+  static void with_closure_frame(SkInvokedMethod * scope_p, _LambdaType && iterator)
+    {
+    SkClosure * closure_p = scope_p->get_arg_data<SkClosure>(SkArg_1);
+    SkClosureInfoMethod * info_p = static_cast<SkClosureInfoMethod *>(closure_p->get_info());
+    SkInvokedMethod imethod(scope_p, closure_p, info_p, a_stack_allocate(info_p->get_invoked_data_array_size(), SkInstance*));
+
+    SKDEBUG_ICALL_SET_INTERNAL(&imethod);
+
+    ClosureFrame frame(&imethod, closure_p, scope_p);
+    iterator(frame);
+    }
+
+  //---------------------------------------------------------------------------------------
+  // Return this list as result
+  static void return_this(SkInstance * this_p, SkInstance ** result_pp)
+    {
+    if (result_pp)
+      {
+      this_p->reference();
+      *result_pp = this_p;
+      }
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   List@do((ItemClass_ item) code) ThisClass_
+  static void mthd_do(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkInstance * this_p = scope_p->get_this();
+    SkInstanceList & list = this_p->as<SkList>();
+
+    if (list.get_length())
+      {
+      with_closure_frame(scope_p, [&list](ClosureFrame & frame)
+        {
+        // Length is re-read on each item since the closure may modify the list
+        for (uint32_t idx = 0u; idx < list.get_length(); ++idx)
+          {
+          SkInstance * item_p = list[idx];
+          item_p->reference();
+          frame.call(&item_p, 1u);
+          }
+        });
+      }
+
+    return_this(this_p, result_pp);
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   List@do_idx((ItemClass_ item Integer idx) code) ThisClass_
+  static void mthd_do_idx(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkInstance * this_p = scope_p->get_this();
+    SkInstanceList & list = this_p->as<SkList>();
+
+    if (list.get_length())
+      {
+      with_closure_frame(scope_p, [&list](ClosureFrame & frame)
+        {
+        SkInstance * args_p[2];
+        for (uint32_t idx = 0u; idx < list.get_length(); ++idx)
+          {
+          args_p[0] = list[idx];
+          args_p[0]->reference();
+          args_p[1] = SkInteger::new_instance(tSkInteger(idx));
+          frame.call(args_p, 2u);
+          }
+        });
+      }
+
+    return_this(this_p, result_pp);
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   List@do_reverse((ItemClass_ item) code) ThisClass_
+  static void mthd_do_reverse(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkInstance * this_p = scope_p->get_this();
+    SkInstanceList & list = this_p->as<SkList>();
+
+    if (list.get_length())
+      {
+      with_closure_frame(scope_p, [&list](ClosureFrame & frame)
+        {
+        for (uint32_t idx = list.get_length(); idx-- > 0u;)
+          {
+          // Skip items removed by the closure
+          if (idx < list.get_length())
+            {
+            SkInstance * item_p = list[idx];
+            item_p->reference();
+            frame.call(&item_p, 1u);
+            }
+          }
+        });
+      }
+
+    return_this(this_p, result_pp);
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   List@any?((ItemClass_ item) Boolean test) Boolean
+  static void mthd_anyQ(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkInstanceList & list = scope_p->this_as<SkList>();
+    bool result = false;
+
+    if (list.get_length())
+      {
+      with_closure_frame(scope_p, [&list, &result](ClosureFrame & frame)
+        {
+        for (uint32_t idx = 0u; !result && idx < list.get_length(); ++idx)
+          {
+          result = frame.query(list[idx]);
+          }
+        });
+      }
+
+    if (result_pp)
+      {
+      *result_pp = SkBoolean::new_instance(result);
+      }
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   List@all?((ItemClass_ item) Boolean test) Boolean
+  static void mthd_allQ(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkInstanceList & list = scope_p->this_as<SkList>();
+    bool result = false;
+
+    // An empty list returns false
+    if (list.get_length())
+      {
+      result = true;
+      with_closure_frame(scope_p, [&list, &result](ClosureFrame & frame)
+        {
+        for (uint32_t idx = 0u; result && idx < list.get_length(); ++idx)
+          {
+          result = frame.query(list[idx]);
+          }
+        });
+      }
+
+    if (result_pp)
+      {
+      *result_pp = SkBoolean::new_instance(result);
+      }
+    }
+
+  //---------------------------------------------------------------------------------------
+  // Keep the items for which the closure returns `keep_result`, remove all others
+  static void filter(SkInvokedMethod * scope_p, SkInstance ** result_pp, bool keep_result)
+    {
+    SkInstance * this_p = scope_p->get_this();
+    SkInstanceList & list = this_p->as<SkList>();
+
+    if (list.get_length())
+      {
+      with_closure_frame(scope_p, [&list, keep_result](ClosureFrame & frame)
+        {
+        // Items are removed one at a time so the list stays valid should the closure look at it
+        uint32_t idx = 0u;
+        while (idx < list.get_length())
+          {
+          if (frame.query(list[idx]) == keep_result)
+            {
+            ++idx;
+            }
+          else if (idx < list.get_length())
+            {
+            list.remove_all(idx, 1u);
+            }
+          }
+        });
+      }
+
+    return_this(this_p, result_pp);
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   List@select((ItemClass_ item) Boolean test) ThisClass_
+  static void mthd_select(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    filter(scope_p, result_pp, true);
+    }
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   List@reject((ItemClass_ item) Boolean test) ThisClass_
+  static void mthd_reject(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    filter(scope_p, result_pp, false);
+    }
+
+  static const SkClass::MethodInitializerFunc methods_i[] =
+    {
+      { "do",         mthd_do },
+      { "do_idx",     mthd_do_idx },
+      { "do_reverse", mthd_do_reverse },
+      { "any?",       mthd_anyQ },
+      { "all?",       mthd_allQ },
+      { "select",     mthd_select },
+      { "reject",     mthd_reject },
+    };
+
+  } // SkUEList_Impl
+
+//---------------------------------------------------------------------------------------
+// Must be called after SkBrain::register_builtin_bindings() since it rebinds some of the
+// built-in List methods
+void SkUEList_Ext::register_bindings()
+  {
+  SkList::get_class()->register_method_func_bulk(SkUEList_Impl::methods_i, A_COUNT_OF(SkUEList_Impl::methods_i), SkBindFlag_instance_rebind);
+  }
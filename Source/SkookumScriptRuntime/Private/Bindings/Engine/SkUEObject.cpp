@@ -0,0 +1,60 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Additional bindings for the Object class
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEObject.hpp"
+#include "../SkUERuntime.hpp"
+
+#include <SkookumScript/SkClass.hpp>
+#include <SkookumScript/SkInvokedMethod.hpp>
+
+//=======================================================================================
+// Method Definitions
+//=======================================================================================
+
+namespace SkUEObject_Impl
+  {
+
+  //---------------------------------------------------------------------------------------
+  // # Skookum:   Object@prefetch()
+  static void mthdc_prefetch(SkInvokedMethod * scope_p, SkInstance ** result_pp)
+    {
+    SkUERuntime::get_singleton()->prefetch_class_group(*scope_p->get_this()->as_data<SkClass>());
+    }
+
+  static const SkClass::MethodInitializerFunc methods_c[] =
+    {
+      { "prefetch", mthdc_prefetch },
+    };
+
+  } // SkUEObject_Impl
+
+//---------------------------------------------------------------------------------------
+
+void SkUEObject_Ext::register_bindings()
+  {
+  SkBrain::ms_object_class_p->register_method_func_bulk(SkUEObject_Impl::methods_c, A_COUNT_OF(SkUEObject_Impl::methods_c), SkBindFlag_class_no_rebind);
+  }
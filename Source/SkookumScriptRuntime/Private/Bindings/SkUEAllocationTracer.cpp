@@ -0,0 +1,373 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Script allocations per call site
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEAllocationTracer.hpp"
+#include "ISkookumScriptRuntime.h"
+#include "SkUEHeatMap.hpp"
+#include "SkUEUtils.hpp"
+
+#include "Algo/BinarySearch.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include <SkookumScript/SkDebug.hpp>
+#include <SkookumScript/SkExpressionBase.hpp>
+#include <SkookumScript/SkInvokableBase.hpp>
+#include <SkookumScript/SkInvokedBase.hpp>
+#include <SkookumScript/SkMemberInfo.hpp>
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+namespace
+  {
+
+  //---------------------------------------------------------------------------------------
+  // Allocations of a script file line - cells of the same line are merged
+  struct Row
+    {
+    FString  m_file;
+    int32    m_line;
+    uint32_t m_source_idx;
+    FString  m_type_name;
+    int64    m_count;
+    int64    m_bytes;
+    };
+
+  //---------------------------------------------------------------------------------------
+  // Merges the cells by script file line and type, sorted by bytes - most first
+  void build_rows(TArray<Row> * rows_p)
+    {
+    TMap<FString, TArray<int32>> file_lines;
+    TMap<FString, int32>         row_map;
+
+    for (const SkUEAllocationTracer::Cell & cell : SkUEAllocationTracer::get_cells())
+      {
+      FString file = cell.m_class_name / cell.m_file_title;
+
+      TArray<int32> * line_starts_p = file_lines.Find(file);
+      if (!line_starts_p)
+        {
+        line_starts_p = &file_lines.Add(file);
+        SkUEHeatMap::find_script_file(cell.m_class_name, cell.m_file_title, line_starts_p);
+        }
+
+      // Line numbers are 1-based, 0 means the file or position is unknown
+      int32 line = 0;
+      if (line_starts_p->Num() && cell.m_source_idx != SkExpr_char_pos_invalid)
+        {
+        line = Algo::UpperBound(*line_starts_p, int32(cell.m_source_idx));
+        }
+
+      FString row_name = line
+        ? FString::Printf(TEXT("%s:%d %s"), *file, line, *cell.m_type_name)
+        : FString::Printf(TEXT("%s#%u %s"), *file, cell.m_source_idx, *cell.m_type_name);
+      int32 * row_idx_p = row_map.Find(row_name);
+      if (!row_idx_p)
+        {
+        row_idx_p = &row_map.Add(row_name, rows_p->AddZeroed());
+        Row & row = (*rows_p)[*row_idx_p];
+        row.m_file       = file;
+        row.m_line       = line;
+        row.m_source_idx = cell.m_source_idx;
+        row.m_type_name  = cell.m_type_name;
+        }
+
+      Row & row = (*rows_p)[*row_idx_p];
+      row.m_count += cell.m_count;
+      row.m_bytes += cell.m_bytes;
+      row.m_source_idx = FMath::Min(row.m_source_idx, cell.m_source_idx);
+      }
+
+    rows_p->Sort([](const Row & lhs, const Row & rhs) { return lhs.m_bytes > rhs.m_bytes; });
+    }
+
+  //---------------------------------------------------------------------------------------
+  // Sk.Alloc start|stop|reset|top [count]|export [path]
+  void alloc_command(const TArray<FString> & args)
+    {
+    FString command = args.Num() ? args[0] : FString(TEXT("top"));
+
+    if (command == TEXT("start"))
+      {
+      SkUEAllocationTracer::enable(true);
+      }
+    else if (command == TEXT("stop"))
+      {
+      SkUEAllocationTracer::enable(false);
+      }
+    else if (command == TEXT("reset"))
+      {
+      SkUEAllocationTracer::reset();
+      }
+    else if (command == TEXT("top"))
+      {
+      SkUEAllocationTracer::log_top((args.Num() > 1) ? FCString::Atoi(*args[1]) : 20);
+      }
+    else if (command == TEXT("export"))
+      {
+      FString path = (args.Num() > 1)
+        ? args[1]
+        : FPaths::ProfilingDir() / TEXT("SkookumScript") / (TEXT("Allocations-") + FDateTime::Now().ToString() + TEXT(".csv"));
+      if (SkUEAllocationTracer::export_csv(path))
+        {
+        UE_LOG(LogSkookum, Display, TEXT("Wrote SkookumScript allocations to '%s'."), *path);
+        }
+      else
+        {
+        UE_LOG(LogSkookum, Warning, TEXT("Unable to write SkookumScript allocations to '%s'."), *path);
+        }
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Unknown Sk.Alloc command '%s' - use start, stop, reset, top or export."), *command);
+      }
+    }
+
+  FAutoConsoleCommand s_alloc_cmd(
+    TEXT("Sk.Alloc"),
+    TEXT("SkookumScript allocations per call site: 'Sk.Alloc start|stop|reset', 'Sk.Alloc top [count]' to log the top allocating lines or 'Sk.Alloc export [path.csv]'."),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&alloc_command));
+
+  } // End unnamed namespace
+
+//=======================================================================================
+// SkUEAllocationTracer Class Data
+//=======================================================================================
+
+bool                                    SkUEAllocationTracer::ms_is_enabled;
+TArray<SkUEAllocationTracer::Cell>      SkUEAllocationTracer::ms_cells;
+TMap<SkUEAllocationTracer::Key, int32>  SkUEAllocationTracer::ms_cell_map;
+TMap<FString, int32>                    SkUEAllocationTracer::ms_cell_name_map;
+bool                                    SkUEAllocationTracer::ms_is_recording;
+uint64                                  SkUEAllocationTracer::ms_start_frame;
+uint64                                  SkUEAllocationTracer::ms_frames;
+TMap<TPair<const SkInvokableBase *, const SkExpressionBase *>, bool> SkUEAllocationTracer::ms_expr_owners;
+
+//=======================================================================================
+// SkUEAllocationTracer Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Starts or stops tracing - traced allocations are kept until reset()
+
+void SkUEAllocationTracer::enable(bool enable_b)
+  {
+  #if (SKOOKUM & SK_DEBUG)
+    if (enable_b == ms_is_enabled)
+      {
+      return;
+      }
+
+    if (enable_b)
+      {
+      ms_start_frame = GFrameCounter;
+      }
+    else
+      {
+      ms_frames += GFrameCounter - ms_start_frame;
+      }
+    ms_is_enabled = enable_b;
+
+    UE_LOG(LogSkookum, Display, TEXT("SkookumScript allocation tracer %s."), enable_b ? TEXT("started") : TEXT("stopped"));
+  #else
+    UE_LOG(LogSkookum, Warning, TEXT("The SkookumScript allocation tracer needs call tracking which is not present in this build configuration."));
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+// Discards everything traced so far
+
+void SkUEAllocationTracer::reset()
+  {
+  ms_cells.Reset();
+  ms_cell_map.Reset();
+  ms_cell_name_map.Reset();
+  ms_expr_owners.Reset();
+  ms_start_frame = GFrameCounter;
+  ms_frames      = 0u;
+  }
+
+//---------------------------------------------------------------------------------------
+// Called when invokables are about to be freed or replaced (e.g. on live update or when
+// the compiled binaries are reloaded). Traced cells are kept and matched up again by
+// file name.
+
+void SkUEAllocationTracer::forget_invokables()
+  {
+  ms_cell_map.Reset();
+  ms_expr_owners.Reset();
+  }
+
+//---------------------------------------------------------------------------------------
+// Number of frames traced so far
+
+uint64 SkUEAllocationTracer::get_frames()
+  {
+  return ms_frames + (ms_is_enabled ? GFrameCounter - ms_start_frame : 0u);
+  }
+
+//---------------------------------------------------------------------------------------
+// Heap allocation made through FAppInfo::malloc() - tagged with the current call site
+
+void SkUEAllocationTracer::on_alloc_internal(size_t size, const char * type_name_p)
+  {
+  #if (SKOOKUM & SK_DEBUG)
+    if (ms_is_recording || !IsInGameThread())
+      {
+      return;
+      }
+
+    const SkInvokedContextBase * context_p = SkDebug::ms_current_call_p.get_obj();
+    if (!context_p)
+      {
+      return;
+      }
+
+    const SkInvokableBase *  invokable_p = context_p->get_invokable();
+    const SkExpressionBase * expr_p      = SkInvokedContextBase::ms_last_expr_p;
+    uint32_t                 source_idx  = (expr_p && is_expr_of(invokable_p, expr_p)) ? expr_p->m_source_idx : SkExpr_char_pos_invalid;
+    record(invokable_p, source_idx, type_name_p ? type_name_p : "?", 1, int64(size));
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+// Determines if `expr_p` is an expression of the routine `invokable_p` - the last
+// expression may still be one of a callee that has returned or of the caller. The result
+// is cached per pair since looking up the expression walks the routine.
+
+bool SkUEAllocationTracer::is_expr_of(const SkInvokableBase * invokable_p, const SkExpressionBase * expr_p)
+  {
+  #if (SKOOKUM & SK_DEBUG)
+    TPair<const SkInvokableBase *, const SkExpressionBase *> key(invokable_p, expr_p);
+    if (const bool * is_owner_p = ms_expr_owners.Find(key))
+      {
+      return *is_owner_p;
+      }
+
+    TGuardValue<bool> recording(ms_is_recording, true);
+    bool is_owner = invokable_p->find_expr_by_pos(expr_p->m_source_idx) == expr_p;
+    ms_expr_owners.Add(key, is_owner);
+    return is_owner;
+  #else
+    return false;
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+// Adds `count` allocations of `bytes` total of type `type_name_p` to the expression at
+// `source_idx` of the routine `invokable_p`
+
+void SkUEAllocationTracer::record(const SkInvokableBase * invokable_p, uint32_t source_idx, const char * type_name_p, int64 count, int64 bytes)
+  {
+  // Resolving names allocates as well
+  TGuardValue<bool> recording(ms_is_recording, true);
+
+  Key key{invokable_p, source_idx, type_name_p};
+
+  int32 cell_idx;
+  if (const int32 * cell_idx_p = ms_cell_map.Find(key))
+    {
+    cell_idx = *cell_idx_p;
+    }
+  else
+    {
+    // First time since the invokables were forgotten - resolve file and merge by it
+    FString class_name(TEXT("?"));
+    FString file_title(TEXT("?"));
+    #if defined(SK_AS_STRINGS) && (SKOOKUM & SK_DEBUG)
+      SkMemberInfo member_info(SkQualifier(*invokable_p), invokable_p->get_member_type(), invokable_p->is_class_member());
+      class_name = FString(invokable_p->get_scope()->get_name_cstr_dbg());
+      file_title = AStringToFString(member_info.as_file_title(SkMemberInfo::PathFlag__file));
+    #endif
+    FString type_name(type_name_p);
+
+    FString full_name = FString::Printf(TEXT("%s/%s#%u %s"), *class_name, *file_title, source_idx, *type_name);
+    if (const int32 * cell_idx_p = ms_cell_name_map.Find(full_name))
+      {
+      cell_idx = *cell_idx_p;
+      }
+    else
+      {
+      cell_idx = ms_cells.AddZeroed();
+      Cell & cell = ms_cells[cell_idx];
+      cell.m_class_name = class_name;
+      cell.m_file_title = file_title;
+      cell.m_source_idx = source_idx;
+      cell.m_type_name  = type_name;
+      ms_cell_name_map.Add(full_name, cell_idx);
+      }
+    ms_cell_map.Add(key, cell_idx);
+    }
+
+  Cell & cell = ms_cells[cell_idx];
+  cell.m_count += count;
+  cell.m_bytes += bytes;
+  }
+
+//---------------------------------------------------------------------------------------
+// Logs the `count` lines that allocated the most bytes
+
+void SkUEAllocationTracer::log_top(int32 count)
+  {
+  TArray<Row> rows;
+  build_rows(&rows);
+
+  double frames = double(FMath::Max<uint64>(get_frames(), 1u));
+
+  UE_LOG(LogSkookum, Display, TEXT("Top SkookumScript allocating lines over %llu frames:"), get_frames());
+  for (int32 row_idx = 0; row_idx < FMath::Min(count, rows.Num()); ++row_idx)
+    {
+    const Row & row = rows[row_idx];
+    UE_LOG(LogSkookum, Display, TEXT("  %8.1f allocs %10.1f bytes per frame  %s  %s:%d"),
+      double(row.m_count) / frames, double(row.m_bytes) / frames, *row.m_type_name, *row.m_file, row.m_line);
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes one line per script file line and type sorted by bytes
+
+bool SkUEAllocationTracer::export_csv(const FString & path)
+  {
+  TArray<Row> rows;
+  build_rows(&rows);
+
+  double frames = double(FMath::Max<uint64>(get_frames(), 1u));
+
+  FString csv(TEXT("file,line,char_idx,type,count,bytes,count_per_frame,bytes_per_frame\n"));
+  for (const Row & row : rows)
+    {
+    csv += FString::Printf(TEXT("\"%s\",%d,%u,%s,%lld,%lld,%.2f,%.2f\n"),
+      *row.m_file.Replace(TEXT("\""), TEXT("\"\"")), row.m_line, row.m_source_idx, *row.m_type_name,
+      row.m_count, row.m_bytes, double(row.m_count) / frames, double(row.m_bytes) / frames);
+    }
+
+  return FFileHelper::SaveStringToFile(csv, *path);
+  }
@@ -0,0 +1,120 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Script allocations per call site
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+class SkExpressionBase;
+class SkInvokableBase;
+
+//---------------------------------------------------------------------------------------
+// Aggregates allocation counts and bytes per script call site - routine, source index
+// and type - to find the lines that create the most objects per frame.
+//
+// Every SkookumScript heap allocation going through FAppInfo::malloc() (e.g. SkClosure,
+// lists, string buffers) on the game thread is tagged with the current call and counted
+// exactly. The position is taken from `SkInvokedContextBase::ms_last_expr_p`, which is
+// not restored when a call returns, so it is only used if the expression belongs to the
+// current routine - otherwise the allocation is filed under the routine without a line.
+//
+// Pooled objects (SkInstance, SkDataInstance, SkInvokedCoroutine, AStringRef) are
+// recycled inside the SkookumScript library without a per-object hook and so are not
+// traced - see the pool stats of the memory telemetry for those.
+//
+// Needs SK_DEBUG (i.e. Development) for the call tracking. Toggled and reported with the
+// `Sk.Alloc` console command.
+class SkUEAllocationTracer
+  {
+  public:
+
+  // Public Types
+
+    struct Cell
+      {
+      FString  m_class_name;
+      FString  m_file_title;
+      uint32_t m_source_idx;
+      FString  m_type_name;
+      int64    m_count;
+      int64    m_bytes;
+      };
+
+  // Class Methods
+
+    static bool is_enabled()                        { return ms_is_enabled; }
+    static void enable(bool enable_b = true);
+    static void reset();
+    static void forget_invokables();
+
+    static void on_alloc(size_t size, const char * type_name_p)
+      { if (ms_is_enabled) { on_alloc_internal(size, type_name_p); } }
+
+    static const TArray<Cell> & get_cells()         { return ms_cells; }
+    static uint64 get_frames();
+
+    static void log_top(int32 count);
+    static bool export_csv(const FString & path);
+
+  protected:
+
+  // Internal Structures
+
+    struct Key
+      {
+      const SkInvokableBase * m_invokable_p;
+      uint32_t                m_source_idx;
+      const char *            m_type_name_p;
+
+      bool operator==(const Key & other) const  { return m_invokable_p == other.m_invokable_p && m_source_idx == other.m_source_idx && m_type_name_p == other.m_type_name_p; }
+      friend uint32 GetTypeHash(const Key & key) { return HashCombine(HashCombine(PointerHash(key.m_invokable_p), key.m_source_idx), PointerHash(key.m_type_name_p)); }
+      };
+
+  // Internal Class Methods
+
+    static void on_alloc_internal(size_t size, const char * type_name_p);
+    static bool is_expr_of(const SkInvokableBase * invokable_p, const SkExpressionBase * expr_p);
+    static void record(const SkInvokableBase * invokable_p, uint32_t source_idx, const char * type_name_p, int64 count, int64 bytes);
+
+  // Class Data Members
+
+    static bool                 ms_is_enabled;
+    static TArray<Cell>         ms_cells;
+    static TMap<Key, int32>     ms_cell_map;
+    static TMap<FString, int32> ms_cell_name_map;
+    static bool                 ms_is_recording;  // Guards against allocations made while recording
+    static uint64               ms_start_frame;
+    static uint64               ms_frames;        // Frames enabled before ms_start_frame
+
+    // Whether an expression belongs to a routine - see is_expr_of()
+    static TMap<TPair<const SkInvokableBase *, const SkExpressionBase *>, bool> ms_expr_owners;
+
+  };  // SkUEAllocationTracer
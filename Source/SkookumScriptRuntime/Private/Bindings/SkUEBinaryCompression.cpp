@@ -0,0 +1,294 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Block-compressed container for compiled binaries
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEBinaryCompression.hpp"
+
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "HAL/ThreadSafeCounter.h"
+
+//=======================================================================================
+// SkUEBinaryCompression Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Determines if binary is a block-compressed container
+
+bool SkUEBinaryCompression::is_compressed(const void * binary_p, uint32_t size)
+  {
+  return size >= sizeof(Header) && static_cast<const Header *>(binary_p)->m_magic == Magic;
+  }
+
+//---------------------------------------------------------------------------------------
+// Decompresses container that is entirely in memory (e.g. memory mapped) - blocks are
+// decompressed in parallel on the game thread and inline on any other thread.
+// 
+// Returns: heap memory (FMemory) with uncompressed binary or nullptr if corrupt
+uint8_t * SkUEBinaryCompression::decompress(const void * binary_p, uint32_t size, uint32_t * uncompressed_size_p)
+  {
+  const Header & header = *static_cast<const Header *>(binary_p);
+  if (!is_compressed(binary_p, size) || !is_header_valid(header, size))
+    {
+    return nullptr;
+    }
+
+  const uint32_t * block_sizes_p = reinterpret_cast<const uint32_t *>(&header + 1);
+  const uint8_t *  blocks_p      = reinterpret_cast<const uint8_t *>(block_sizes_p + header.m_block_count);
+
+  // Offset of each block within the container
+  TArray<uint32_t> offsets;
+  offsets.SetNumUninitialized(header.m_block_count);
+  uint64_t offset = 0u;
+  for (uint32_t block_idx = 0u; block_idx < header.m_block_count; block_idx++)
+    {
+    offsets[block_idx] = uint32_t(offset);
+    offset += block_sizes_p[block_idx];
+    }
+  if (uint64_t(blocks_p - static_cast<const uint8_t *>(binary_p)) + offset > size)
+    {
+    return nullptr;
+    }
+
+  uint8_t * uncompressed_p = static_cast<uint8_t *>(FMemory::Malloc(header.m_uncompressed_size));
+  FThreadSafeCounter failures;
+  ParallelFor(int32(header.m_block_count), [&](int32 block_idx)
+    {
+    uint32_t block_start = uint32_t(block_idx) * header.m_block_size;
+    if (!decompress_block(
+      uncompressed_p + block_start, 
+      FMath::Min(header.m_block_size, header.m_uncompressed_size - block_start),
+      blocks_p + offsets[block_idx], 
+      block_sizes_p[block_idx]))
+      {
+      failures.Increment();
+      }
+    }, !IsInGameThread());
+
+  if (failures.GetValue())
+    {
+    FMemory::Free(uncompressed_p);
+    return nullptr;
+    }
+
+  *uncompressed_size_p = header.m_uncompressed_size;
+  return uncompressed_p;
+  }
+
+//---------------------------------------------------------------------------------------
+// Reads the rest of a container whose header has already been read from `reader_p` and
+// decompresses it block by block while it streams in. On the game thread the next block
+// is read on the thread pool while the current one is decompressed. Anywhere else - e.g.
+// a class group prefetch on a pool worker - blocks are read and decompressed inline so a
+// worker never blocks on work queued behind it.
+// 
+// Returns: heap memory (FMemory) with uncompressed binary or nullptr if corrupt
+uint8_t * SkUEBinaryCompression::read_decompress(FArchive * reader_p, const Header & header)
+  {
+  if (!is_header_valid(header, uint64_t(reader_p->TotalSize())))
+    {
+    return nullptr;
+    }
+
+  TArray<uint32_t> block_sizes;
+  block_sizes.SetNumUninitialized(header.m_block_count);
+  reader_p->Serialize(block_sizes.GetData(), header.m_block_count * sizeof(uint32_t));
+
+  uint64_t compressed_size = 0u;
+  uint32_t block_size_max  = 0u;
+  for (uint32_t block_size : block_sizes)
+    {
+    compressed_size += block_size;
+    block_size_max   = FMath::Max(block_size_max, block_size);
+    }
+  if (reader_p->IsError() || uint64_t(reader_p->Tell()) + compressed_size > uint64_t(reader_p->TotalSize()))
+    {
+    return nullptr;
+    }
+
+  // Two block buffers - one being decompressed while the other one is being read
+  TArray<uint8_t> buffers[2];
+  buffers[0].SetNumUninitialized(block_size_max);
+  buffers[1].SetNumUninitialized(block_size_max);
+
+  bool is_pipelined = IsInGameThread();
+  bool is_ok = true;
+  if (header.m_block_count)
+    {
+    reader_p->Serialize(buffers[0].GetData(), block_sizes[0]);
+    is_ok = !reader_p->IsError();
+    }
+
+  uint8_t * uncompressed_p = static_cast<uint8_t *>(FMemory::Malloc(header.m_uncompressed_size));
+  for (uint32_t block_idx = 0u; is_ok && block_idx < header.m_block_count; block_idx++)
+    {
+    uint8_t * next_p    = buffers[(block_idx + 1u) & 1u].GetData();
+    uint32_t  next_size = (block_idx + 1u < header.m_block_count) ? block_sizes[block_idx + 1u] : 0u;
+
+    TFuture<bool> next_read;
+    if (next_size && is_pipelined)
+      {
+      next_read = Async<bool>(EAsyncExecution::ThreadPool, [reader_p, next_p, next_size]()
+        {
+        reader_p->Serialize(next_p, next_size);
+        return !reader_p->IsError();
+        });
+      }
+
+    uint32_t block_start = block_idx * header.m_block_size;
+    is_ok = decompress_block(
+      uncompressed_p + block_start,
+      FMath::Min(header.m_block_size, header.m_uncompressed_size - block_start),
+      buffers[block_idx & 1u].GetData(),
+      block_sizes[block_idx]);
+
+    // The read writes into the other buffer so it is waited for even if decompressing failed
+    if (next_read.IsValid())
+      {
+      is_ok = next_read.Get() && is_ok;
+      }
+    else if (next_size && is_ok)
+      {
+      reader_p->Serialize(next_p, next_size);
+      is_ok = !reader_p->IsError();
+      }
+    }
+
+  if (!is_ok)
+    {
+    FMemory::Free(uncompressed_p);
+    return nullptr;
+    }
+
+  return uncompressed_p;
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes `src_path_p` as block-compressed container to `dst_path_p` - which may be the
+// same file. Files that are already compressed are left as they are.
+bool SkUEBinaryCompression::compress_file(const TCHAR * src_path_p, const TCHAR * dst_path_p, uint32_t block_size, Stats * stats_p)
+  {
+  double start_time = FPlatformTime::Seconds();
+
+  TArray<uint8> src;
+  if (!FFileHelper::LoadFileToArray(src, src_path_p) || block_size == 0u)
+    {
+    return false;
+    }
+
+  if (is_compressed(src.GetData(), src.Num()))
+    {
+    if (stats_p)
+      {
+      stats_p->m_uncompressed_size = static_cast<const Header *>((const void *)src.GetData())->m_uncompressed_size;
+      stats_p->m_compressed_size   = src.Num();
+      stats_p->m_seconds           = 0.0;
+      }
+    return FCString::Strcmp(src_path_p, dst_path_p) == 0 || FFileHelper::SaveArrayToFile(src, dst_path_p);
+    }
+
+  Header header;
+  header.m_magic             = Magic;
+  header.m_block_size        = block_size;
+  header.m_uncompressed_size = src.Num();
+  header.m_block_count       = (header.m_uncompressed_size + block_size - 1u) / block_size;
+
+  // Compress blocks in parallel - blocks that do not get smaller are stored as they are
+  TArray<TArray<uint8>> blocks;
+  blocks.SetNum(header.m_block_count);
+  ParallelFor(int32(header.m_block_count), [&](int32 block_idx)
+    {
+    const uint8 * block_p          = src.GetData() + uint32_t(block_idx) * block_size;
+    int32         block_src_size   = int32(FMath::Min(block_size, header.m_uncompressed_size - uint32_t(block_idx) * block_size));
+    int32         compressed_size  = FCompression::CompressMemoryBound(NAME_Zlib, block_src_size);
+    TArray<uint8> & block          = blocks[block_idx];
+
+    block.SetNumUninitialized(compressed_size);
+    if (FCompression::CompressMemory(NAME_Zlib, block.GetData(), compressed_size, block_p, block_src_size)
+      && compressed_size < block_src_size)
+      {
+      block.SetNum(compressed_size, false);
+      }
+    else
+      {
+      block.SetNum(0, false);
+      block.Append(block_p, block_src_size);
+      }
+    });
+
+  TArray<uint8> dst;
+  dst.Append(reinterpret_cast<const uint8 *>(&header), sizeof(header));
+  for (const TArray<uint8> & block : blocks)
+    {
+    uint32_t compressed_size = block.Num();
+    dst.Append(reinterpret_cast<const uint8 *>(&compressed_size), sizeof(compressed_size));
+    }
+  for (const TArray<uint8> & block : blocks)
+    {
+    dst.Append(block);
+    }
+
+  if (!FFileHelper::SaveArrayToFile(dst, dst_path_p))
+    {
+    return false;
+    }
+
+  if (stats_p)
+    {
+    stats_p->m_uncompressed_size = header.m_uncompressed_size;
+    stats_p->m_compressed_size   = dst.Num();
+    stats_p->m_seconds           = FPlatformTime::Seconds() - start_time;
+    }
+
+  return true;
+  }
+
+//---------------------------------------------------------------------------------------
+
+bool SkUEBinaryCompression::is_header_valid(const Header & header, uint64_t container_size)
+  {
+  return header.m_magic == Magic
+    && header.m_block_size > 0u
+    && uint64_t(header.m_block_count) == (uint64_t(header.m_uncompressed_size) + header.m_block_size - 1u) / header.m_block_size
+    && sizeof(Header) + uint64_t(header.m_block_count) * sizeof(uint32_t) <= container_size;
+  }
+
+//---------------------------------------------------------------------------------------
+// Blocks that have the same size compressed as uncompressed are stored uncompressed
+
+bool SkUEBinaryCompression::decompress_block(uint8_t * dst_p, uint32_t dst_size, const uint8_t * src_p, uint32_t src_size)
+  {
+  if (src_size == dst_size)
+    {
+    FMemory::Memcpy(dst_p, src_p, dst_size);
+    return true;
+    }
+
+  return FCompression::UncompressMemory(NAME_Zlib, dst_p, int32(dst_size), src_p, int32(src_size));
+  }
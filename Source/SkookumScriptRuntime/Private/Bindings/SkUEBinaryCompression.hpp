@@ -0,0 +1,87 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Block-compressed container for compiled binaries
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+
+class FArchive;
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Optional container for compiled binaries (.sk-bin/.sk-sym) that stores their content
+// as independently compressed blocks. Layout:
+//
+//   Header   - magic, block size, uncompressed size, block count
+//   uint32_t - compressed size of each block (equal to the uncompressed block size if
+//              the block is stored uncompressed)
+//   blocks   - back to back
+//
+// Each demand-loaded class group has its own binary file, so groups can still be loaded
+// individually. Loading detects the container by its magic so raw and compressed binaries
+// can be mixed.
+class SkUEBinaryCompression
+  {
+  public:
+
+    enum
+      {
+      Magic             = 0x315a4b53,  // 'SKZ1'
+      Block_size_def    = 64 * 1024
+      };
+
+    struct Header
+      {
+      uint32_t m_magic;
+      uint32_t m_block_size;
+      uint32_t m_uncompressed_size;
+      uint32_t m_block_count;
+      };
+
+    struct Stats
+      {
+      uint32_t m_uncompressed_size;
+      uint32_t m_compressed_size;
+      double   m_seconds;
+      };
+
+  // Class Methods
+
+    static bool      is_compressed(const void * binary_p, uint32_t size);
+    static uint8_t * decompress(const void * binary_p, uint32_t size, uint32_t * uncompressed_size_p);
+    static uint8_t * read_decompress(FArchive * reader_p, const Header & header);
+    static bool      compress_file(const TCHAR * src_path_p, const TCHAR * dst_path_p, uint32_t block_size = Block_size_def, Stats * stats_p = nullptr);
+
+  protected:
+
+    static bool      is_header_valid(const Header & header, uint64_t container_size);
+    static bool      decompress_block(uint8_t * dst_p, uint32_t dst_size, const uint8_t * src_p, uint32_t src_size);
+
+  };  // SkUEBinaryCompression
@@ -26,6 +26,10 @@
 //=======================================================================================
 
 #include "SkUEBindings.hpp"
+#include "SkUEStartupProfiler.hpp"
+
+#include "Core/SkUEBenchmark.hpp"
+#include "Core/SkUEList.hpp"
 
 #include "VectorMath/SkVector2.hpp"
 #include "VectorMath/SkVector3.hpp"
@@ -36,6 +40,7 @@
 #include "VectorMath/SkColor.hpp"
 
 #include "Engine/SkUEName.hpp"
+#include "Engine/SkUEObject.hpp"
 #include "Engine/SkUEActor.hpp"
 #include "Engine/SkUEActorComponent.hpp"
 #include "Engine/SkUEEntity.hpp"
@@ -66,6 +71,7 @@ void SkUEBindings::ensure_static_ue_types_registered(SkUEBindingsInterface * pro
   // Register generated classes
   if (!s_engine_ue_types_registered)
     {
+    SkUEStartupProfiler::Scope phase(TEXT("Engine-Generated register_static_ue_types"));
     s_engine_generated_bindings.register_static_ue_types();
 
     // Manually register additional classes
@@ -89,7 +95,10 @@ void SkUEBindings::ensure_static_ue_types_registered(SkUEBindingsInterface * pro
 void SkUEBindings::begin_register_bindings()
   {
   // Register built-in bindings at this point
+  {
+  SkUEStartupProfiler::Scope phase(TEXT("SkBrain::register_builtin_bindings"));
   SkBrain::register_builtin_bindings();
+  }
 
   // Core Overlay
   SkBoolean::get_class()->register_raw_accessor_func(&SkUEClassBindingHelper::access_raw_data_boolean);
@@ -98,6 +107,10 @@ void SkUEBindings::begin_register_bindings()
   SkString::get_class()->register_raw_accessor_func(&SkUEClassBindingHelper::access_raw_data_string);
   SkEnum::get_class()->register_raw_accessor_func(&SkUEClassBindingHelper::access_raw_data_enum);
   SkList::get_class()->register_raw_accessor_func(&SkUEClassBindingHelper::access_raw_data_list);
+  SkUEList_Ext::register_bindings();
+
+  // Core-Test Overlay - only bound when compiled in
+  SkUEBenchmark::register_bindings();
 
   // VectorMath Overlay
   SkVector2::register_bindings();
@@ -110,10 +123,17 @@ void SkUEBindings::begin_register_bindings()
 
   // Engine-Generated/Project-Generated-C++ Overlay
   // Register static Sk types on both overlays, but register bindings only on one of them
+  {
+  SkUEStartupProfiler::Scope phase(TEXT("Engine-Generated register_static_sk_types"));
   s_engine_generated_bindings.register_static_sk_types();
+  }
+  {
+  SkUEStartupProfiler::Scope phase(TEXT("Engine-Generated register_bindings"));
   s_engine_generated_bindings.register_bindings();
+  }
 
   // Engine Overlay
+  SkUEObject_Ext::register_bindings();
   SkUEEntity_Ext::register_bindings();
   SkUEEntityClass_Ext::register_bindings();
   SkUEActor_Ext::register_bindings();
@@ -133,7 +153,13 @@ void SkUEBindings::finish_register_bindings(SkUEBindingsInterface * project_gene
   {
   if (project_generated_bindings_p)
     {
+    {
+    SkUEStartupProfiler::Scope phase(TEXT("Project-Generated register_static_sk_types"));
     project_generated_bindings_p->register_static_sk_types();
+    }
+    {
+    SkUEStartupProfiler::Scope phase(TEXT("Project-Generated register_bindings"));
     project_generated_bindings_p->register_bindings();
     }
+    }
   }
@@ -0,0 +1,480 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Attribution of script time and allocations to receiver classes and owning actors
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUECostAttribution.hpp"
+#include "ISkookumScriptRuntime.h"
+#include "SkUEScriptSampler.hpp"
+#include "SkUEUtils.hpp"
+#include "Engine/SkUEEntity.hpp"
+
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+#include <SkookumScript/SkClass.hpp>
+#include <SkookumScript/SkInvokedCoroutine.hpp>
+#include <SkookumScript/SkMind.hpp>
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+DECLARE_STATS_GROUP(TEXT("SkookumScript Classes"), STATGROUP_SkookumScriptClasses, STATCAT_Advanced);
+DECLARE_STATS_GROUP(TEXT("SkookumScript Actors"), STATGROUP_SkookumScriptActors, STATCAT_Advanced);
+
+namespace
+  {
+
+  //---------------------------------------------------------------------------------------
+  // Sk.Cost start [sample interval]|stop|reset|top [count]
+  void cost_command(const TArray<FString> & args)
+    {
+    FString command = args.Num() ? args[0] : FString(TEXT("top"));
+
+    if (command == TEXT("start"))
+      {
+      SkUECostAttribution::enable(true, (args.Num() > 1) ? uint32(FMath::Max(FCString::Atoi(*args[1]), 1)) : 8u);
+      }
+    else if (command == TEXT("stop"))
+      {
+      SkUECostAttribution::enable(false);
+      }
+    else if (command == TEXT("reset"))
+      {
+      SkUECostAttribution::reset();
+      }
+    else if (command == TEXT("top"))
+      {
+      SkUECostAttribution::print_top((args.Num() > 1) ? FCString::Atoi(*args[1]) : 10);
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Unknown Sk.Cost command '%s' - use start, stop, reset or top."), *command);
+      }
+    }
+
+  FAutoConsoleCommand s_cost_cmd(
+    TEXT("Sk.Cost"),
+    TEXT("SkookumScript cost per class and actor: 'Sk.Cost start [sample interval]|stop|reset' or 'Sk.Cost top [count]' to print the most expensive ones."),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&cost_command));
+
+  //---------------------------------------------------------------------------------------
+  template<class _KeyType>
+  void print_costs(const TCHAR * title_p, const TMap<_KeyType, SkUECostAttribution::Cost> & costs, int32 count)
+    {
+    TArray<const SkUECostAttribution::Cost *> sorted;
+    for (const TPair<_KeyType, SkUECostAttribution::Cost> & cost : costs)
+      {
+      sorted.Add(&cost.Value);
+      }
+    sorted.Sort([](const SkUECostAttribution::Cost & lhs, const SkUECostAttribution::Cost & rhs) { return lhs.m_cycles > rhs.m_cycles; });
+
+    UE_LOG(LogSkookum, Display, TEXT("Most expensive SkookumScript %s:"), title_p);
+    for (int32 idx = 0; idx < FMath::Min(count, sorted.Num()); ++idx)
+      {
+      const SkUECostAttribution::Cost & cost = *sorted[idx];
+      UE_LOG(LogSkookum, Display, TEXT("  %10.3fms %10lld allocs %12lld bytes  %s"),
+        FPlatformTime::ToMilliseconds64(cost.m_cycles), cost.m_allocs, cost.m_alloc_bytes, *cost.m_name);
+      }
+    }
+
+  } // End unnamed namespace
+
+//=======================================================================================
+// SkUECostAttribution Class Data
+//=======================================================================================
+
+bool                                                SkUECostAttribution::ms_is_enabled;
+bool                                                SkUECostAttribution::ms_is_measuring;
+uint32                                              SkUECostAttribution::ms_sample_interval = 8u;
+uint32                                              SkUECostAttribution::ms_entry_count;
+uint32                                              SkUECostAttribution::ms_update_count;
+uint32                                              SkUECostAttribution::ms_split_updates;
+uint32                                              SkUECostAttribution::ms_sampled_updates;
+TArray<SkUECostAttribution::Target>                 SkUECostAttribution::ms_targets;
+uint64                                              SkUECostAttribution::ms_start_cycles;
+volatile int64                                      SkUECostAttribution::ms_alloc_count;
+volatile int64                                      SkUECostAttribution::ms_alloc_bytes;
+bool                                                SkUECostAttribution::ms_is_update_sampled;
+TArray<SkUECostAttribution::Target>                 SkUECostAttribution::ms_update_targets;
+uint64                                              SkUECostAttribution::ms_pending_cycles;
+int64                                               SkUECostAttribution::ms_pending_allocs;
+int64                                               SkUECostAttribution::ms_pending_alloc_bytes;
+TMap<uint32, SkUECostAttribution::Cost>             SkUECostAttribution::ms_class_costs;
+TMap<TWeakObjectPtr<AActor>, SkUECostAttribution::Cost> SkUECostAttribution::ms_actor_costs;
+TMap<FName, SkUECostAttribution::Cost>              SkUECostAttribution::ms_actor_class_costs;
+
+//=======================================================================================
+// SkUECostAttribution Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Starts or stops attribution - every sample_interval-th entry (and update if it is not
+// distributed by samples) is measured. Where call tracking exists the sampler is started
+// so updates can be distributed by samples.
+
+void SkUECostAttribution::enable(bool enable_b, uint32 sample_interval)
+  {
+  ms_is_enabled = enable_b;
+  ms_sample_interval = FMath::Max(sample_interval, 1u);
+
+  #if (SKOOKUM & SK_DEBUG)
+    if (enable_b && !SkUEScriptSampler::is_running())
+      {
+      SkUEScriptSampler::start();
+      }
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUECostAttribution::reset()
+  {
+  ms_class_costs.Reset();
+  ms_actor_costs.Reset();
+  ms_actor_class_costs.Reset();
+  ms_update_targets.Reset();
+  ms_pending_cycles      = 0u;
+  ms_pending_allocs      = 0;
+  ms_pending_alloc_bytes = 0;
+  ms_split_updates       = 0u;
+  ms_sampled_updates     = 0u;
+  }
+
+//---------------------------------------------------------------------------------------
+// Called once per frame after the sampler has been drained - distributes sampled updates,
+// drops destroyed actors and sets the stats of this frame's costs
+
+void SkUECostAttribution::publish()
+  {
+  if (!ms_is_enabled)
+    {
+    return;
+    }
+
+  charge_sampled_update();
+  prune_actors();
+
+  #if STATS
+    if (!FThreadStats::IsCollectingData())
+      {
+      return;
+      }
+
+    for (TPair<uint32, Cost> & cost : ms_class_costs)
+      {
+      if (cost.Value.m_frame_cycles)
+        {
+        FThreadStats::AddMessage(cost.Value.m_stat_id.GetName(), EStatOperation::Set, int64(cost.Value.m_frame_cycles), true);
+        cost.Value.m_frame_cycles = 0u;
+        }
+      }
+
+    for (TPair<FName, Cost> & cost : ms_actor_class_costs)
+      {
+      if (cost.Value.m_frame_cycles)
+        {
+        FThreadStats::AddMessage(cost.Value.m_stat_id.GetName(), EStatOperation::Set, int64(cost.Value.m_frame_cycles), true);
+        cost.Value.m_frame_cycles = 0u;
+        }
+      }
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUECostAttribution::print_top(int32 count)
+  {
+  print_costs(TEXT("classes"), ms_class_costs, count);
+  print_costs(TEXT("actor classes"), ms_actor_class_costs, count);
+  print_costs(TEXT("actors"), ms_actor_costs, count);
+
+  if (ms_sampled_updates)
+    {
+    UE_LOG(LogSkookum, Display, TEXT("%u coroutine updates were distributed by call stack samples."), ms_sampled_updates);
+    }
+  if (ms_split_updates)
+    {
+    UE_LOG(LogSkookum, Display, TEXT("%u coroutine updates were split evenly across the receivers of the scheduled coroutines - their share of the costs above is an estimate."), ms_split_updates);
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Called on the game thread for each drained sample taken during a sampled update
+
+void SkUECostAttribution::add_update_sample(uint32 class_id, UObject * obj_p)
+  {
+  Target & target = ms_update_targets[ms_update_targets.AddDefaulted()];
+  target.m_class_id = class_id;
+  target.m_actor = resolve_actor(obj_p);
+  }
+
+//---------------------------------------------------------------------------------------
+// Starts measuring an entry into script if it is the outermost one and is sampled
+
+bool SkUECostAttribution::begin(const SkObjectBase * scope_p)
+  {
+  // Nested entries are part of the one being measured
+  if (ms_is_measuring || (++ms_entry_count % ms_sample_interval))
+    {
+    return false;
+    }
+
+  ms_targets.SetNum(1, false);
+  resolve_target(scope_p ? scope_p->get_topmost_scope() : nullptr, &ms_targets[0]);
+  begin_measuring();
+  return true;
+  }
+
+//---------------------------------------------------------------------------------------
+// Starts measuring the coroutine update. If the sampler is running, every update is
+// measured and distributed by samples later. Otherwise only sampled updates are measured
+// and the receivers of the coroutines are gathered up front to split it across since
+// they may be gone once the update is done.
+
+bool SkUECostAttribution::begin_update()
+  {
+  if (ms_is_measuring)
+    {
+    return false;
+    }
+
+  ms_is_update_sampled = SkUEScriptSampler::is_running();
+  if (ms_is_update_sampled)
+    {
+    begin_measuring();
+    return true;
+    }
+
+  if (++ms_update_count % ms_sample_interval)
+    {
+    return false;
+    }
+
+  ms_targets.Reset();
+  const AList<SkMind> & minds = SkMind::get_updating_minds();
+  for (SkMind * mind_p = minds.get_first_null(); mind_p; mind_p = minds.get_next_null(mind_p))
+    {
+    AList<SkInvokedCoroutine> & icoroutines = mind_p->get_invoked_coroutines();
+    for (SkInvokedCoroutine * icoro_p = icoroutines.get_first_null(); icoro_p; icoro_p = icoroutines.get_next_null(icoro_p))
+      {
+      resolve_target(icoro_p->get_topmost_scope(), &ms_targets[ms_targets.AddDefaulted()]);
+      }
+    }
+
+  if (!ms_targets.Num())
+    {
+    return false;
+    }
+
+  begin_measuring();
+  return true;
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUECostAttribution::begin_measuring()
+  {
+  ms_alloc_count  = 0;
+  ms_alloc_bytes  = 0;
+  ms_is_measuring = true;
+  ms_start_cycles = FPlatformTime::Cycles64();
+  }
+
+//---------------------------------------------------------------------------------------
+// Charges the measured cost scaled by the sample interval to the targets
+
+void SkUECostAttribution::end()
+  {
+  uint64 cycles = FPlatformTime::Cycles64() - ms_start_cycles;
+  ms_is_measuring = false;
+
+  uint64 scale = ms_sample_interval;
+  charge_targets(ms_targets, cycles * scale, ms_alloc_count * int64(scale), ms_alloc_bytes * int64(scale));
+  }
+
+//---------------------------------------------------------------------------------------
+// Splits the update evenly or, if it is distributed by samples, keeps its cost until the
+// samples taken during it have been drained - see charge_sampled_update()
+
+void SkUECostAttribution::end_update()
+  {
+  if (!ms_is_update_sampled)
+    {
+    end();
+    ++ms_split_updates;
+    return;
+    }
+
+  ms_is_measuring = false;
+  ms_pending_cycles      += FPlatformTime::Cycles64() - ms_start_cycles;
+  ms_pending_allocs      += ms_alloc_count;
+  ms_pending_alloc_bytes += ms_alloc_bytes;
+  ++ms_sampled_updates;
+  }
+
+//---------------------------------------------------------------------------------------
+// Splits cost evenly across the targets - a receiver appearing several times gets a
+// share for each
+
+void SkUECostAttribution::charge_targets(const TArray<Target> & targets, uint64 cycles, int64 allocs, int64 alloc_bytes)
+  {
+  uint32 target_count = uint32(targets.Num());
+  uint64 target_cycles = cycles / target_count;
+  int64  target_allocs = allocs / target_count;
+  int64  target_alloc_bytes = alloc_bytes / target_count;
+
+  for (const Target & target : targets)
+    {
+    charge(&get_class_cost(target.m_class_id), target_cycles, target_allocs, target_alloc_bytes);
+    AActor * actor_p = target.m_actor.Get();
+    if (actor_p)
+      {
+      charge(&get_actor_cost(target.m_actor), target_cycles, target_allocs, target_alloc_bytes);
+      charge(&get_actor_class_cost(actor_p->GetClass()), target_cycles, target_allocs, target_alloc_bytes);
+      }
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Distributes the cost of sampled updates across the receivers found in their samples.
+// Updates too short to be sampled are carried over to the next one that is.
+
+void SkUECostAttribution::charge_sampled_update()
+  {
+  if (!ms_update_targets.Num())
+    {
+    return;
+    }
+
+  charge_targets(ms_update_targets, ms_pending_cycles, ms_pending_allocs, ms_pending_alloc_bytes);
+  ms_update_targets.Reset();
+  ms_pending_cycles      = 0u;
+  ms_pending_allocs      = 0;
+  ms_pending_alloc_bytes = 0;
+  }
+
+//---------------------------------------------------------------------------------------
+// Drops destroyed actors - their cost remains in the cost of their actor class
+
+void SkUECostAttribution::prune_actors()
+  {
+  for (auto cost_iter = ms_actor_costs.CreateIterator(); cost_iter; ++cost_iter)
+    {
+    if (!cost_iter.Key().IsValid())
+      {
+      cost_iter.RemoveCurrent();
+      }
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Determines the class of the receiver and the actor that owns it (if any)
+
+void SkUECostAttribution::resolve_target(SkInstance * receiver_p, Target * target_p)
+  {
+  SkClass * class_p = receiver_p ? receiver_p->get_class() : nullptr;
+  target_p->m_class_id = class_p ? class_p->get_name_id() : 0u;
+
+  UObject * obj_p = (class_p && class_p->is_class(*SkUEEntity::get_class())) ? receiver_p->as<SkUEEntity>().get_obj() : nullptr;
+  target_p->m_actor = resolve_actor(obj_p);
+  }
+
+//---------------------------------------------------------------------------------------
+// The actor itself, the owner of a component or the outer actor of any other object
+
+AActor * SkUECostAttribution::resolve_actor(UObject * obj_p)
+  {
+  AActor * actor_p = Cast<AActor>(obj_p);
+  if (!actor_p && obj_p)
+    {
+    UActorComponent * component_p = Cast<UActorComponent>(obj_p);
+    actor_p = component_p ? component_p->GetOwner() : obj_p->GetTypedOuter<AActor>();
+    }
+  return actor_p;
+  }
+
+//---------------------------------------------------------------------------------------
+
+SkUECostAttribution::Cost & SkUECostAttribution::get_class_cost(uint32 class_id)
+  {
+  Cost * cost_p = ms_class_costs.Find(class_id);
+  if (!cost_p)
+    {
+    cost_p = &ms_class_costs.Add(class_id);
+    *cost_p = Cost();
+    cost_p->m_name = class_id ? AStringToFString(ASymbol::create_existing(class_id).as_string()) : FString(TEXT("(none)"));
+    #if STATS
+      cost_p->m_stat_id = FDynamicStats::CreateStatId<STAT_GROUP_TO_FStatGroup(STATGROUP_SkookumScriptClasses)>(cost_p->m_name);
+    #endif
+    }
+  return *cost_p;
+  }
+
+//---------------------------------------------------------------------------------------
+
+SkUECostAttribution::Cost & SkUECostAttribution::get_actor_cost(const TWeakObjectPtr<AActor> & actor)
+  {
+  Cost * cost_p = ms_actor_costs.Find(actor);
+  if (!cost_p)
+    {
+    cost_p = &ms_actor_costs.Add(actor);
+    *cost_p = Cost();
+    cost_p->m_name = actor->GetName();
+    }
+  return *cost_p;
+  }
+
+//---------------------------------------------------------------------------------------
+// Actor stats are per actor class since dynamic stats can not be removed again
+
+SkUECostAttribution::Cost & SkUECostAttribution::get_actor_class_cost(const UClass * class_p)
+  {
+  Cost * cost_p = ms_actor_class_costs.Find(class_p->GetFName());
+  if (!cost_p)
+    {
+    cost_p = &ms_actor_class_costs.Add(class_p->GetFName());
+    *cost_p = Cost();
+    cost_p->m_name = class_p->GetName();
+    #if STATS
+      cost_p->m_stat_id = FDynamicStats::CreateStatId<STAT_GROUP_TO_FStatGroup(STATGROUP_SkookumScriptActors)>(cost_p->m_name);
+    #endif
+    }
+  return *cost_p;
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUECostAttribution::charge(Cost * cost_p, uint64 cycles, int64 allocs, int64 alloc_bytes)
+  {
+  cost_p->m_cycles       += cycles;
+  cost_p->m_frame_cycles += cycles;
+  cost_p->m_allocs       += allocs;
+  cost_p->m_alloc_bytes  += alloc_bytes;
+  cost_p->m_samples++;
+  }
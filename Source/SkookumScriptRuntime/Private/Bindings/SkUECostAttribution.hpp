@@ -0,0 +1,175 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Attribution of script time and allocations to receiver classes and owning actors
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "UObject/WeakObjectPtr.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+class AActor;
+class SkInstance;
+class SkObjectBase;
+class UClass;
+class UObject;
+
+//---------------------------------------------------------------------------------------
+// Charges the time and SkookumScript allocations of script execution to the class of the
+// receiver and to the actor that owns the receiver (the actor itself, the owner of a
+// component or the outer actor of any other object).
+//
+// Measured are the outermost entries into script (Blueprint calls, callbacks, delegates -
+// see Scope) and the coroutine update (see UpdateScope). Only every n-th entry is
+// measured and counts are scaled by n so the cost stays low.
+//
+// The update runs many coroutines at once. Where call tracking exists (SK_DEBUG) every
+// update is measured and its cost is distributed over the receivers SkUEScriptSampler
+// found executing while it ran. Otherwise every n-th update is split evenly across the
+// receivers of the scheduled coroutines, which is only an estimate - `Sk.Cost top` says
+// which of the two was used.
+//
+// Costs show up in the `stat SkookumScriptClasses` and `stat SkookumScriptActors` groups
+// (where stats are compiled in) and `Sk.Cost top [count]` prints the most expensive ones.
+// Actor stats are per actor class so they stay bounded, and destroyed actors are dropped
+// from the per actor costs in publish() - their cost remains in their actor class.
+class SkUECostAttribution
+  {
+  public:
+
+  // Nested Structures
+
+    struct Cost
+      {
+      FString m_name;
+      uint64  m_cycles;         // Scaled by the sample interval
+      int64   m_allocs;         // Scaled by the sample interval
+      int64   m_alloc_bytes;    // Scaled by the sample interval
+      int64   m_samples;
+      uint64  m_frame_cycles;   // Since the last publish()
+      #if STATS
+        TStatId m_stat_id;
+      #endif
+      };
+
+    // Measures one entry into script if it is sampled
+    class Scope
+      {
+      public:
+        Scope(const SkObjectBase * scope_p) : m_is_measured(ms_is_enabled && begin(scope_p)) {}
+        ~Scope()                                                                             { if (m_is_measured) { end(); } }
+
+      protected:
+        bool m_is_measured;
+      };
+
+    // Measures the coroutine update if it is sampled
+    class UpdateScope
+      {
+      public:
+        UpdateScope() : m_is_measured(ms_is_enabled && begin_update()) {}
+        ~UpdateScope()                                                  { if (m_is_measured) { end_update(); } }
+
+      protected:
+        bool m_is_measured;
+      };
+
+  // Class Methods
+
+    static bool is_enabled()                     { return ms_is_enabled; }
+    static void enable(bool enable_b = true, uint32 sample_interval = 8u);
+    static void reset();
+    static void publish();
+    static void print_top(int32 count);
+
+    static void on_alloc(size_t size)            { if (ms_is_measuring) { FPlatformAtomics::InterlockedIncrement(&ms_alloc_count); FPlatformAtomics::InterlockedAdd(&ms_alloc_bytes, int64(size)); } }
+
+    // Called on the game thread for each drained sample taken during the update
+    static void add_update_sample(uint32 class_id, UObject * obj_p);
+
+    static const TMap<uint32, Cost> &                  get_class_costs()        { return ms_class_costs; }
+    static const TMap<TWeakObjectPtr<AActor>, Cost> &  get_actor_costs()        { return ms_actor_costs; }
+    static const TMap<FName, Cost> &                   get_actor_class_costs()  { return ms_actor_class_costs; }
+
+  protected:
+
+  // Internal Structures
+
+    struct Target
+      {
+      uint32                 m_class_id;
+      TWeakObjectPtr<AActor> m_actor;
+      };
+
+  // Internal Class Methods
+
+    static bool   begin(const SkObjectBase * scope_p);
+    static bool   begin_update();
+    static void   begin_measuring();
+    static void   end();
+    static void   end_update();
+    static void   charge_targets(const TArray<Target> & targets, uint64 cycles, int64 allocs, int64 alloc_bytes);
+    static void   charge_sampled_update();
+    static void   prune_actors();
+    static void   resolve_target(SkInstance * receiver_p, Target * target_p);
+    static AActor * resolve_actor(UObject * obj_p);
+    static Cost & get_class_cost(uint32 class_id);
+    static Cost & get_actor_cost(const TWeakObjectPtr<AActor> & actor);
+    static Cost & get_actor_class_cost(const UClass * class_p);
+    static void   charge(Cost * cost_p, uint64 cycles, int64 allocs, int64 alloc_bytes);
+
+  // Class Data Members
+
+    static bool                                 ms_is_enabled;
+    static bool                                 ms_is_measuring;
+    static uint32                               ms_sample_interval;
+    static uint32                               ms_entry_count;
+    static uint32                               ms_update_count;
+    static uint32                               ms_split_updates;     // Updates split evenly
+    static uint32                               ms_sampled_updates;   // Updates distributed by samples
+
+    // Current measurement
+    static TArray<Target>                       ms_targets;
+    static uint64                               ms_start_cycles;
+    static volatile int64                       ms_alloc_count;
+    static volatile int64                       ms_alloc_bytes;
+
+    // Sampled updates - cost of updates not yet distributed and the samples taken since
+    static bool                                 ms_is_update_sampled;
+    static TArray<Target>                       ms_update_targets;
+    static uint64                               ms_pending_cycles;
+    static int64                                ms_pending_allocs;
+    static int64                                ms_pending_alloc_bytes;
+
+    static TMap<uint32, Cost>                   ms_class_costs;
+    static TMap<TWeakObjectPtr<AActor>, Cost>   ms_actor_costs;
+    static TMap<FName, Cost>                    ms_actor_class_costs;
+
+  };  // SkUECostAttribution
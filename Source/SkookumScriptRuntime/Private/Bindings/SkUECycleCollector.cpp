@@ -0,0 +1,515 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Incremental cycle collector for reference counted SkookumScript instances
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUECycleCollector.hpp"
+#include "SkUEReleaseQueue.hpp"
+
+#include "HAL/PlatformTime.h"
+#include "Stats/Stats.h"
+
+#include <SkookumScript/Sk.hpp>
+#include <SkookumScript/SkBrain.hpp>
+#include <SkookumScript/SkClass.hpp>
+#include <SkookumScript/SkClosure.hpp>
+#include <SkookumScript/SkDataInstance.hpp>
+#include <SkookumScript/SkList.hpp>
+
+DECLARE_CYCLE_STAT(TEXT("SkookumScript Cycle Collector"), STAT_SkookumScriptCycleCollector, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("SkookumScript Cycle Candidates"), STAT_SkookumScriptCycleCandidates, STATGROUP_Game);
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+namespace
+{
+
+  // How the children of an instance are found
+  enum eTraceKind
+    {
+    TraceKind_none,     // No references to other instances that we know of
+    TraceKind_data,     // SkDataInstance - data members
+    TraceKind_list,     // List - items
+    TraceKind_closure,  // SkClosure - receiver and captured variables
+    };
+
+  //---------------------------------------------------------------------------------------
+  // Mirrors the decisions made by SkClass::new_instance()
+  eTraceKind get_trace_kind(SkInstance * instance_p)
+    {
+    switch (instance_p->get_obj_type())
+      {
+      case SkObjectType_closure:
+        return TraceKind_closure;
+
+      case SkObjectType_mind:
+        return TraceKind_data;
+
+      case SkObjectType_instance:
+      case SkObjectType_actor:
+        {
+        SkClass * class_p = instance_p->get_class();
+        if (class_p->is_class(*SkList::get_class()))
+          {
+          return TraceKind_list;
+          }
+        return class_p->get_total_data_count() ? TraceKind_data : TraceKind_none;
+        }
+
+      default:
+        return TraceKind_none;
+      }
+    }
+
+} // End unnamed namespace
+
+//=======================================================================================
+// SkUECycleCollector Methods
+//=======================================================================================
+
+SkUECycleCollector * SkUECycleCollector::ms_singleton_p;
+
+//---------------------------------------------------------------------------------------
+
+SkUECycleCollector::SkUECycleCollector()
+  : m_is_enabled(true)
+  , m_time_slice_ms(0.25)
+  , m_max_trial_nodes(4096u)
+  , m_candidate_idx(0)
+  {
+  SK_ASSERTX(!ms_singleton_p, "There can be only one instance of this class.");
+  ms_singleton_p = this;
+
+  FMemory::Memzero(m_stats);
+  }
+
+//---------------------------------------------------------------------------------------
+
+SkUECycleCollector::~SkUECycleCollector()
+  {
+  SK_ASSERTX_NO_THROW(m_candidate_set.Num() == 0, "Cycle collector destroyed while still holding on to candidates - collect_all() should have been called at shutdown.");
+  SK_ASSERTX_NO_THROW(ms_singleton_p == this, "There can be only one instance of this class.");
+  ms_singleton_p = nullptr;
+  }
+
+//---------------------------------------------------------------------------------------
+// Releases a reference to an instance that the plugin holds on to, like dereference().
+// If the instance survives the release it may be part of a garbage cycle, so instead of
+// decrementing its reference count the reference is handed over to the candidate buffer.
+// Only buffers while gameplay is running - see collect_all().
+void SkUECycleCollector::release(SkInstance * instance_p)
+  {
+  if (ms_singleton_p
+    && ms_singleton_p->m_is_enabled
+    && instance_p->get_references() > 1u
+    && SkookumScript::get_initialization_level() >= SkookumScript::InitializationLevel_gameplay)
+    {
+    ms_singleton_p->add_candidate(instance_p);
+    }
+  else
+    {
+    SkUEReleaseQueue::release(instance_p);
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Adds an instance to the candidate buffer - takes over one reference held by the caller
+void SkUECycleCollector::add_candidate(SkInstance * instance_p)
+  {
+  bool is_already_buffered = true;
+  if (is_traceable(instance_p))
+    {
+    m_candidate_set.Add(instance_p, &is_already_buffered);
+    }
+
+  if (is_already_buffered)
+    {
+    // Already holding a reference or of no interest
+    instance_p->dereference();
+    return;
+    }
+
+  m_candidates.Add(instance_p);
+  ++m_stats.m_candidates_buffered;
+  }
+
+//---------------------------------------------------------------------------------------
+// Processes buffered candidates until the time slice is used up
+void SkUECycleCollector::update()
+  {
+  if (!m_is_enabled || m_candidate_set.Num() == 0)
+    {
+    return;
+    }
+
+  SCOPE_CYCLE_COUNTER(STAT_SkookumScriptCycleCollector);
+
+  double start_time = FPlatformTime::Seconds();
+  double end_time = start_time + m_time_slice_ms * 0.001;
+
+  while (m_candidate_idx < m_candidates.Num())
+    {
+    SkInstance * candidate_p = m_candidates[m_candidate_idx++];
+
+    // Entries are removed from the set lazily when consumed by an earlier trial
+    if (m_candidate_set.Remove(candidate_p))
+      {
+      process_candidate(candidate_p);
+      if (FPlatformTime::Seconds() >= end_time)
+        {
+        break;
+        }
+      }
+    }
+
+  if (m_candidate_idx >= m_candidates.Num())
+    {
+    m_candidates.Reset();
+    m_candidate_idx = 0;
+    }
+
+  m_stats.m_candidates_pending = m_candidate_set.Num();
+  m_stats.m_last_update_ms = (FPlatformTime::Seconds() - start_time) * 1000.0;
+  SET_DWORD_STAT(STAT_SkookumScriptCycleCandidates, m_stats.m_candidates_pending);
+  }
+
+//---------------------------------------------------------------------------------------
+// Processes all buffered candidates regardless of time - call after gameplay has been
+// deinitialized and before the sim is so no references are held past that point.
+void SkUECycleCollector::collect_all()
+  {
+  // Collecting can run script destructors which may add more candidates
+  while (m_candidate_idx < m_candidates.Num())
+    {
+    SkInstance * candidate_p = m_candidates[m_candidate_idx++];
+    if (m_candidate_set.Remove(candidate_p))
+      {
+      process_candidate(candidate_p);
+      }
+    }
+
+  m_candidates.Reset();
+  m_candidate_idx = 0;
+  m_stats.m_candidates_pending = 0u;
+  }
+
+//---------------------------------------------------------------------------------------
+
+bool SkUECycleCollector::is_traceable(SkInstance * instance_p) const
+  {
+  if (!instance_p->is_ref_counted())
+    {
+    return false;
+    }
+
+  // Skip instances in the middle of being destroyed and ones that are never freed
+  uint32_t ref_count = instance_p->get_references();
+  if (ref_count == 0u || ref_count >= SkInstanceUnreffed_infinite_ref_count)
+    {
+    return false;
+    }
+
+  return get_trace_kind(instance_p) != TraceKind_none;
+  }
+
+//---------------------------------------------------------------------------------------
+// Calls functor with each instance referenced by instance_p - once per reference held
+template<typename _FunctorType>
+void SkUECycleCollector::for_each_child(SkInstance * instance_p, _FunctorType && functor) const
+  {
+  switch (get_trace_kind(instance_p))
+    {
+    case TraceKind_data:
+      {
+      SkDataInstance * data_instance_p = static_cast<SkDataInstance *>(instance_p);
+      uint32_t data_count = instance_p->get_class()->get_total_data_count();
+      for (uint32_t data_idx = 0u; data_idx < data_count; ++data_idx)
+        {
+        SkInstance * data_p = data_instance_p->get_data_by_idx(data_idx);
+        if (data_p)
+          {
+          functor(data_p);
+          }
+        }
+      break;
+      }
+
+    case TraceKind_list:
+      {
+      SkInstanceList & list = instance_p->as<SkList>();
+      SkInstance ** items_pp = list.get_array();
+      SkInstance ** items_end_pp = items_pp + list.get_length();
+      for (; items_pp < items_end_pp; ++items_pp)
+        {
+        functor(*items_pp);
+        }
+      break;
+      }
+
+    case TraceKind_closure:
+      {
+      SkClosure * closure_p = static_cast<SkClosure *>(instance_p);
+      SkInstance * receiver_p = closure_p->get_receiver();
+      if (receiver_p)
+        {
+        functor(receiver_p);
+        }
+      SkInstance ** captured_pp = closure_p->get_captured_array();
+      SkInstance ** captured_end_pp = captured_pp + closure_p->get_captured_count();
+      for (; captured_pp < captured_end_pp; ++captured_pp)
+        {
+        if (*captured_pp)
+          {
+          functor(*captured_pp);
+          }
+        }
+      break;
+      }
+
+    default:
+      break;
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Runs a trial deletion starting at candidate_p and frees any garbage found.
+// Consumes the buffer reference held on candidate_p.
+void SkUECycleCollector::process_candidate(SkInstance * candidate_p)
+  {
+  ++m_stats.m_trials;
+
+  if (trace(candidate_p))
+    {
+    free_garbage();
+    }
+  else
+    {
+    ++m_stats.m_trials_aborted;
+    }
+
+  m_nodes.Reset();
+  m_node_map.Reset();
+
+  // Release buffer reference - frees the candidate if it was garbage
+  SkUEReleaseQueue::release(candidate_p);
+  }
+
+//---------------------------------------------------------------------------------------
+// Builds the graph of traceable instances reachable from root_p, counts the references
+// among them and determines which of them are referenced from the outside.
+//
+// Returns: false if the graph got too big to analyze
+bool SkUECycleCollector::trace(SkInstance * root_p)
+  {
+  bool is_too_big = false;
+
+  // Gather nodes and count internal references
+  m_node_map.Add(root_p, 0);
+  m_nodes.Add({ root_p, 1u, false }); // Reference from the candidate buffer
+  for (int32 node_idx = 0; node_idx < m_nodes.Num() && !is_too_big; ++node_idx)
+    {
+    for_each_child(m_nodes[node_idx].m_instance_p, [this, &is_too_big](SkInstance * child_p)
+      {
+      int32 * child_idx_p = m_node_map.Find(child_p);
+      if (child_idx_p)
+        {
+        m_nodes[*child_idx_p].m_internal_refs++;
+        }
+      else if (is_traceable(child_p))
+        {
+        if (uint32_t(m_nodes.Num()) >= m_max_trial_nodes)
+          {
+          is_too_big = true;
+          return;
+          }
+
+        // Other buffered candidates carry an extra reference from the buffer
+        m_node_map.Add(child_p, m_nodes.Num());
+        m_nodes.Add({ child_p, m_candidate_set.Contains(child_p) ? 2u : 1u, false });
+        }
+      });
+    }
+
+  m_stats.m_nodes_scanned += m_nodes.Num();
+
+  if (is_too_big)
+    {
+    return false;
+    }
+
+  // Anything with more references than accounted for is referenced from the outside and
+  // keeps everything it references alive. Fewer references than accounted for means that
+  // some reference was not counted - stay on the safe side and consider it live as well.
+  m_live_stack.Reset();
+  for (int32 node_idx = 0; node_idx < m_nodes.Num(); ++node_idx)
+    {
+    Node & node = m_nodes[node_idx];
+    if (node.m_instance_p->get_references() != node.m_internal_refs)
+      {
+      node.m_is_live = true;
+      m_live_stack.Add(node_idx);
+      }
+    }
+
+  while (m_live_stack.Num())
+    {
+    for_each_child(m_nodes[m_live_stack.Pop(false)].m_instance_p, [this](SkInstance * child_p)
+      {
+      int32 * child_idx_p = m_node_map.Find(child_p);
+      if (child_idx_p && !m_nodes[*child_idx_p].m_is_live)
+        {
+        m_nodes[*child_idx_p].m_is_live = true;
+        m_live_stack.Add(*child_idx_p);
+        }
+      });
+    }
+
+  return true;
+  }
+
+//---------------------------------------------------------------------------------------
+// Breaks the references among the nodes of the last trial that are not live so that
+// reference counting frees them.
+//
+// Script destructors are still called as usual, but note that at that time the data
+// members referring to other instances of the same garbage cycle are already nil.
+void SkUECycleCollector::free_garbage()
+  {
+  m_live_stack.Reset();
+  for (int32 node_idx = 0; node_idx < m_nodes.Num(); ++node_idx)
+    {
+    if (!m_nodes[node_idx].m_is_live)
+      {
+      m_live_stack.Add(node_idx); // Reuse as list of garbage nodes
+      }
+    }
+
+  if (!m_live_stack.Num())
+    {
+    return;
+    }
+
+  ++m_stats.m_cycles_found;
+  m_stats.m_instances_freed += m_live_stack.Num();
+
+  // Hold on to all garbage so nothing gets destroyed while the cycles are broken
+  for (int32 node_idx : m_live_stack)
+    {
+    SkInstance * instance_p = m_nodes[node_idx].m_instance_p;
+    instance_p->reference();
+    instance_p->abort_coroutines_on_this();
+    }
+
+  // Clear all references to other garbage
+  for (int32 node_idx : m_live_stack)
+    {
+    SkInstance * instance_p = m_nodes[node_idx].m_instance_p;
+    auto is_garbage = [this](SkInstance * obj_p)
+      {
+      int32 * idx_p = m_node_map.Find(obj_p);
+      return idx_p && !m_nodes[*idx_p].m_is_live;
+      };
+
+    switch (get_trace_kind(instance_p))
+      {
+      case TraceKind_data:
+        {
+        SkDataInstance * data_instance_p = static_cast<SkDataInstance *>(instance_p);
+        uint32_t data_count = instance_p->get_class()->get_total_data_count();
+        for (uint32_t data_idx = 0u; data_idx < data_count; ++data_idx)
+          {
+          SkInstance ** data_pp = data_instance_p->get_data_addr_by_idx(data_idx);
+          if (*data_pp && is_garbage(*data_pp))
+            {
+            SkInstance * data_p = *data_pp;
+            *data_pp = SkBrain::ms_nil_p;
+            data_p->dereference();
+            }
+          }
+        break;
+        }
+
+      case TraceKind_list:
+        {
+        SkInstanceList & list = instance_p->as<SkList>();
+        for (uint32_t item_idx = list.get_length(); item_idx-- > 0u;)
+          {
+          if (is_garbage(list[item_idx]))
+            {
+            list.remove_all(item_idx, 1u);
+            }
+          }
+        break;
+        }
+
+      case TraceKind_closure:
+        {
+        // The receiver can't be cleared, but any cycle through it must also pass through
+        // a data member, list item or captured variable, which are cleared here
+        SkClosure * closure_p = static_cast<SkClosure *>(instance_p);
+        SkInstance ** captured_pp = closure_p->get_captured_array();
+        SkInstance ** captured_end_pp = captured_pp + closure_p->get_captured_count();
+        for (; captured_pp < captured_end_pp; ++captured_pp)
+          {
+          if (*captured_pp && is_garbage(*captured_pp))
+            {
+            SkInstance * captured_p = *captured_pp;
+            *captured_pp = SkBrain::ms_nil_p;
+            captured_p->dereference();
+            }
+          }
+        break;
+        }
+
+      default:
+        break;
+      }
+    }
+
+  // Release the buffer references of any other candidates that turned out to be garbage
+  for (int32 node_idx : m_live_stack)
+    {
+    SkInstance * instance_p = m_nodes[node_idx].m_instance_p;
+    if (node_idx != 0 && m_candidate_set.Remove(instance_p))
+      {
+      instance_p->dereference();
+      }
+    }
+
+  // Let go - reference counting takes care of the rest
+  // Copy first since destructors may re-enter release()
+  TArray<SkInstance *> garbage;
+  garbage.Reserve(m_live_stack.Num());
+  for (int32 node_idx : m_live_stack)
+    {
+    garbage.Add(m_nodes[node_idx].m_instance_p);
+    }
+  for (SkInstance * instance_p : garbage)
+    {
+    SkUEReleaseQueue::release(instance_p);
+    }
+  }
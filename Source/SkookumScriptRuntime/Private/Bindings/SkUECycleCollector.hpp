@@ -0,0 +1,134 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Incremental cycle collector for reference counted SkookumScript instances
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+#include "Containers/Set.h"
+
+#include <SkookumScript/SkInstance.hpp>
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Finds and frees cycles of SkookumScript instances that are no longer reachable but keep
+// each other alive through their reference counts - e.g. two data instances pointing at
+// each other, a closure capturing `this` stored in a data member of `this`, or a mind and
+// an actor referring to one another.
+//
+// Uses trial deletion: the references of all instances reachable from a candidate are
+// subtracted from each other in a side table, and whatever is left with no outside
+// references is garbage. Reference counts are only read, never modified during the trial.
+//
+// Candidates are buffered when the plugin releases a reference to an instance that
+// survives the release (see release()), and are processed within a per-frame time slice
+// by update(). Each candidate is analyzed in one go so the object graph can't change
+// underneath a trial.
+//
+// Only instances with script-visible references are traced: data members of
+// SkDataInstance objects (including actors and minds), items of List objects and the
+// receiver/captured variables of closures. Instances that are not reference counted
+// (nil, SkInstanceUnreffed) and instances held by the engine (embedded in a UObject, held
+// by a component, running coroutines etc.) have outside references and are never freed.
+class SkUECycleCollector
+  {
+  public:
+
+    struct Stats
+      {
+      uint32_t  m_candidates_buffered;  // Total candidates ever added to the buffer
+      uint32_t  m_candidates_pending;   // Candidates currently waiting in the buffer
+      uint32_t  m_trials;               // Total trial deletions performed
+      uint32_t  m_trials_aborted;       // Trials given up due to exceeding m_max_trial_nodes
+      uint32_t  m_nodes_scanned;        // Total instances visited by all trials
+      uint32_t  m_cycles_found;         // Trials that found garbage
+      uint32_t  m_instances_freed;      // Total instances released by breaking cycles
+      double    m_last_update_ms;       // Time spent in the most recent update()
+      };
+
+    static SkUECycleCollector * get() { return ms_singleton_p; }
+
+  // Methods
+
+                SkUECycleCollector();
+               ~SkUECycleCollector();
+
+    static void release(SkInstance * instance_p);
+
+    void        add_candidate(SkInstance * instance_p);
+    void        update();
+    void        collect_all();
+
+    bool        is_enabled() const                      { return m_is_enabled; }
+    void        set_enabled(bool is_enabled)            { m_is_enabled = is_enabled; if (!is_enabled) { collect_all(); } }
+    double      get_time_slice_ms() const               { return m_time_slice_ms; }
+    void        set_time_slice_ms(double time_slice_ms) { m_time_slice_ms = time_slice_ms; }
+    const Stats & get_stats() const                     { return m_stats; }
+
+  protected:
+
+  // Internal Methods
+
+    bool        is_traceable(SkInstance * instance_p) const;
+    void        process_candidate(SkInstance * candidate_p);
+    bool        trace(SkInstance * root_p);
+    void        free_garbage();
+
+    template<typename _FunctorType>
+    void        for_each_child(SkInstance * instance_p, _FunctorType && functor) const;
+
+  // Data Members
+
+    struct Node
+      {
+      SkInstance *  m_instance_p;
+      uint32_t      m_internal_refs;  // References coming from other nodes in this trial (plus the buffer)
+      bool          m_is_live;
+      };
+
+    bool              m_is_enabled;
+    double            m_time_slice_ms;    // Time budget per update() in milliseconds
+    uint32_t          m_max_trial_nodes;  // Give up on a candidate if it reaches more instances than this
+
+    // Buffered candidates - each holds one reference on its instance
+    TArray<SkInstance *>  m_candidates;
+    TSet<SkInstance *>    m_candidate_set;
+    int32                 m_candidate_idx; // Next candidate to process
+
+    // Scratch space for a single trial - kept to avoid reallocating each time
+    TArray<Node>              m_nodes;
+    TMap<SkInstance *, int32> m_node_map;
+    TArray<int32>             m_live_stack;
+
+    Stats             m_stats;
+
+    static SkUECycleCollector * ms_singleton_p;
+
+  };  // SkUECycleCollector
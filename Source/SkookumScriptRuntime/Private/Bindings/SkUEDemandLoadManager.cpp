@@ -0,0 +1,236 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Unloads least recently used demand-loaded class groups to stay within a memory budget
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEDemandLoadManager.hpp"
+
+#include "HAL/PlatformTime.h"
+#include "Stats/Stats.h"
+
+#include <AgogCore/AMemory.hpp>
+#include <SkookumScript/SkCoroutine.hpp>
+#include <SkookumScript/SkInvokedCoroutine.hpp>
+#include <SkookumScript/SkMind.hpp>
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("SkookumScript Demand Loaded Groups"), STAT_SkookumScriptDemandLoadedGroups, STATGROUP_Game);
+DECLARE_MEMORY_STAT(TEXT("SkookumScript Demand Loaded Memory"), STAT_SkookumScriptDemandLoadedMemory, STATGROUP_Game);
+
+//=======================================================================================
+// SkUEDemandLoadManager Methods
+//=======================================================================================
+
+SkUEDemandLoadManager * SkUEDemandLoadManager::ms_singleton_p;
+
+//---------------------------------------------------------------------------------------
+
+SkUEDemandLoadManager::SkUEDemandLoadManager()
+  : m_budget_bytes(0u)
+  {
+  SK_ASSERTX(!ms_singleton_p, "There can be only one instance of this class.");
+  ms_singleton_p = this;
+
+  FMemory::Memzero(m_stats);
+  }
+
+//---------------------------------------------------------------------------------------
+
+SkUEDemandLoadManager::~SkUEDemandLoadManager()
+  {
+  SK_ASSERTX_NO_THROW(ms_singleton_p == this, "There can be only one instance of this class.");
+  ms_singleton_p = nullptr;
+  }
+
+//---------------------------------------------------------------------------------------
+// Called once the group with the given root class has been loaded
+
+void SkUEDemandLoadManager::on_group_loaded(SkClass * root_p)
+  {
+  // Measure what the group costs now that it is loaded
+  AMemoryStats mem_stats(AMemoryStats::Track_needed);
+  root_p->track_memory_recursive(&mem_stats, false);
+
+  Group & group = m_groups.FindOrAdd(root_p);
+  m_stats.m_bytes_loaded += mem_stats.m_size_needed - group.m_bytes;
+  group.m_last_use_time = FPlatformTime::Seconds();
+  group.m_bytes = mem_stats.m_size_needed;
+  group.m_is_unload_pending = false;
+
+  ++m_stats.m_loads;
+  if (m_evicted.Remove(root_p))
+    {
+    ++m_stats.m_reloads;
+    }
+  m_stats.m_groups_loaded = m_groups.Num();
+  }
+
+//---------------------------------------------------------------------------------------
+// Mark the group the given class belongs to as recently used
+
+void SkUEDemandLoadManager::touch(const SkClass & cls)
+  {
+  if (!m_groups.Num())
+    {
+    return;
+    }
+
+  SkClass * root_p = cls.get_demand_loaded_root();
+  if (root_p)
+    {
+    Group * group_p = m_groups.Find(root_p);
+    if (group_p)
+      {
+      group_p->m_last_use_time = FPlatformTime::Seconds();
+      }
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Finishes deferred unloads and evicts least recently used groups while over budget
+
+void SkUEDemandLoadManager::update()
+  {
+  // Account for groups that got unloaded since the last update
+  uint32_t pending_bytes = 0u;
+  for (auto group_iter = m_groups.CreateIterator(); group_iter; ++group_iter)
+    {
+    SkClass * root_p = group_iter.Key();
+    Group & group = group_iter.Value();
+    if (!root_p->is_loaded())
+      {
+      m_stats.m_bytes_loaded -= group.m_bytes;
+      if (group.m_is_unload_pending)
+        {
+        ++m_stats.m_evictions;
+        m_evicted.Add(root_p);
+        }
+      group_iter.RemoveCurrent();
+      }
+    else if (group.m_is_unload_pending)
+      {
+      pending_bytes += group.m_bytes;
+      }
+    }
+  m_stats.m_groups_loaded = m_groups.Num();
+
+  if (m_budget_bytes && m_stats.m_bytes_loaded - pending_bytes > m_budget_bytes)
+    {
+    touch_active();
+
+    // Gather eviction candidates, least recently used first
+    m_lru.Reset();
+    for (auto & group_pair : m_groups)
+      {
+      if (!group_pair.Value.m_is_unload_pending && !group_pair.Key->is_load_locked())
+        {
+        m_lru.Add(group_pair.Key);
+        }
+      }
+    m_lru.Sort([this](const SkClass & lhs, const SkClass & rhs)
+      {
+      return m_groups[const_cast<SkClass *>(&lhs)].m_last_use_time < m_groups[const_cast<SkClass *>(&rhs)].m_last_use_time;
+      });
+
+    uint32_t bytes_remaining = m_stats.m_bytes_loaded - pending_bytes;
+    for (SkClass * root_p : m_lru)
+      {
+      if (bytes_remaining <= m_budget_bytes)
+        {
+        break;
+        }
+
+      Group & group = m_groups[root_p];
+      bytes_remaining -= group.m_bytes;
+
+      // Unloads right away if possible or flags the group to be unloaded once no longer in use
+      root_p->demand_unload();
+      group.m_is_unload_pending = true;
+      if (root_p->is_loaded())
+        {
+        ++m_stats.m_deferrals;
+        }
+      else
+        {
+        ++m_stats.m_evictions;
+        m_stats.m_bytes_loaded -= group.m_bytes;
+        m_evicted.Add(root_p);
+        m_groups.Remove(root_p);
+        }
+      }
+    m_stats.m_groups_loaded = m_groups.Num();
+    }
+
+  SET_DWORD_STAT(STAT_SkookumScriptDemandLoadedGroups, m_stats.m_groups_loaded);
+  SET_MEMORY_STAT(STAT_SkookumScriptDemandLoadedMemory, m_stats.m_bytes_loaded);
+  }
+
+//---------------------------------------------------------------------------------------
+// Evicts all groups that are not locked regardless of the budget - e.g. to soak test
+// evicting and reloading groups
+
+void SkUEDemandLoadManager::evict_all()
+  {
+  uint32_t budget_bytes = m_budget_bytes;
+  m_budget_bytes = 1u;
+  update();
+  m_budget_bytes = budget_bytes;
+  }
+
+//---------------------------------------------------------------------------------------
+// Marks the groups of the receivers and routines of all scheduled coroutines as used.
+// Script calls between routines do not go through the plugin, so this is how ongoing
+// script activity keeps groups from being evicted.
+
+void SkUEDemandLoadManager::touch_active()
+  {
+  const AList<SkMind> & minds = SkMind::get_updating_minds();
+  for (SkMind * mind_p = minds.get_first_null(); mind_p; mind_p = minds.get_next_null(mind_p))
+    {
+    touch(*mind_p->get_class());
+
+    AList<SkInvokedCoroutine> & icoroutines = mind_p->get_invoked_coroutines();
+    for (SkInvokedCoroutine * icoro_p = icoroutines.get_first_null(); icoro_p; icoro_p = icoroutines.get_next_null(icoro_p))
+      {
+      touch(*icoro_p->get_coroutine().get_scope());
+
+      SkInstance * receiver_p = icoro_p->get_topmost_scope();
+      if (receiver_p)
+        {
+        touch(*receiver_p->get_class());
+        }
+      }
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Forget all groups - call when the class hierarchy is reloaded or torn down
+
+void SkUEDemandLoadManager::reset()
+  {
+  m_groups.Empty();
+  m_evicted.Empty();
+  m_stats.m_groups_loaded = 0u;
+  m_stats.m_bytes_loaded = 0u;
+  }
@@ -0,0 +1,114 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Unloads least recently used demand-loaded class groups to stay within a memory budget
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "Containers/Array.h"
+#include "Containers/Map.h"
+#include "Containers/Set.h"
+
+#include <SkookumScript/SkClass.hpp>
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Keeps track of loaded demand-loaded class groups (identified by their root class, see
+// SkClass::get_demand_loaded_root()) and unloads the least recently used ones when their
+// combined memory exceeds the budget.
+//
+// A group counts as used when it is loaded, prefetched, when the plugin creates an
+// instance of one of its classes or looks up one of its routines to call it (see
+// touch()). Before evicting, the receivers and coroutines of all scheduled coroutines
+// are touched as well so groups that script is busy with are evicted last. Groups locked
+// with SkClass::lock_load() are never unloaded. If SkClass::demand_unload() has to defer
+// unloading because the group is still in use, the group is left alone until the unload
+// actually happened.
+class SkUEDemandLoadManager
+  {
+  public:
+
+    struct Stats
+      {
+      uint32_t  m_groups_loaded;  // Demand-loaded groups currently loaded
+      uint32_t  m_bytes_loaded;   // Memory used by the groups currently loaded
+      uint32_t  m_loads;          // Total group loads
+      uint32_t  m_reloads;        // Loads of groups that had been evicted before
+      uint32_t  m_evictions;      // Total groups unloaded due to the budget
+      uint32_t  m_deferrals;      // Unloads that had to wait for the group to no longer be in use
+      };
+
+    static SkUEDemandLoadManager * get() { return ms_singleton_p; }
+
+  // Methods
+
+                SkUEDemandLoadManager();
+               ~SkUEDemandLoadManager();
+
+    void        on_group_loaded(SkClass * root_p);
+    void        touch(const SkClass & cls);
+    void        update();
+    void        evict_all();
+    void        reset();
+
+    uint32_t    get_budget_bytes() const                { return m_budget_bytes; }
+    void        set_budget_bytes(uint32_t budget_bytes) { m_budget_bytes = budget_bytes; }
+    const Stats & get_stats() const                     { return m_stats; }
+
+  protected:
+
+  // Internal Methods
+
+    void        touch_active();
+
+  // Data Members
+
+    struct Group
+      {
+      double    m_last_use_time = 0.0;
+      uint32_t  m_bytes = 0u;
+      bool      m_is_unload_pending = false;
+      };
+
+    // Budget in bytes - 0 means unlimited
+    uint32_t                  m_budget_bytes;
+
+    // Loaded demand-loaded groups keyed by their root class
+    TMap<SkClass *, Group>    m_groups;
+
+    // Roots of groups that have been evicted - to tell reloads apart from first loads
+    TSet<SkClass *>           m_evicted;
+
+    // Scratch space for picking groups to evict
+    TArray<SkClass *>         m_lru;
+
+    Stats                     m_stats;
+
+    static SkUEDemandLoadManager * ms_singleton_p;
+
+  };  // SkUEDemandLoadManager
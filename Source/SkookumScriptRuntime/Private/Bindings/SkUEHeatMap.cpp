@@ -0,0 +1,397 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Per-expression execution heat map of script routines
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEHeatMap.hpp"
+#include "ISkookumScriptRuntime.h"
+#include "SkUEUtils.hpp"
+
+#include "Algo/BinarySearch.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include <SkookumScript/SkBrain.hpp>
+#include <SkookumScript/SkClass.hpp>
+#include <SkookumScript/SkDebug.hpp>
+#include <SkookumScript/SkExpressionBase.hpp>
+#include <SkookumScript/SkInvokedCoroutine.hpp>
+#include <SkookumScript/SkMemberInfo.hpp>
+#include <SkookumScript/SkMind.hpp>
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+namespace
+  {
+
+  //---------------------------------------------------------------------------------------
+  // Sk.HeatMap start [time]|stop|reset|export [path]
+  void heat_map_command(const TArray<FString> & args)
+    {
+    FString command = args.Num() ? args[0] : FString(TEXT("export"));
+
+    if (command == TEXT("start"))
+      {
+      SkUEHeatMap::enable(true, args.Num() > 1 && args[1] == TEXT("time"));
+      }
+    else if (command == TEXT("stop"))
+      {
+      SkUEHeatMap::enable(false);
+      }
+    else if (command == TEXT("reset"))
+      {
+      SkUEHeatMap::reset();
+      }
+    else if (command == TEXT("export"))
+      {
+      FString path = (args.Num() > 1)
+        ? args[1]
+        : FPaths::ProfilingDir() / TEXT("SkookumScript") / (TEXT("HeatMap-") + FDateTime::Now().ToString() + TEXT(".csv"));
+      if (SkUEHeatMap::export_csv(path))
+        {
+        UE_LOG(LogSkookum, Display, TEXT("Wrote SkookumScript heat map to '%s'."), *path);
+        }
+      else
+        {
+        UE_LOG(LogSkookum, Warning, TEXT("Unable to write SkookumScript heat map to '%s'."), *path);
+        }
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Unknown Sk.HeatMap command '%s' - use start, stop, reset or export."), *command);
+      }
+    }
+
+  FAutoConsoleCommand s_heat_map_cmd(
+    TEXT("Sk.HeatMap"),
+    TEXT("SkookumScript expression heat map: 'Sk.HeatMap start [time]|stop|reset' or 'Sk.HeatMap export [path.csv]' to write execution counts per script file and line."),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&heat_map_command));
+
+  } // End unnamed namespace
+
+//=======================================================================================
+// SkUEHeatMap Class Data
+//=======================================================================================
+
+bool                            SkUEHeatMap::ms_is_enabled;
+bool                            SkUEHeatMap::ms_is_timed;
+TArray<SkUEHeatMap::Cell>       SkUEHeatMap::ms_cells;
+TMap<SkUEHeatMap::Key, int32>   SkUEHeatMap::ms_cell_map;
+TMap<FString, int32>            SkUEHeatMap::ms_cell_name_map;
+int32                           SkUEHeatMap::ms_last_cell_idx = INDEX_NONE;
+uint64                          SkUEHeatMap::ms_last_cycles;
+
+//=======================================================================================
+// SkUEHeatMap Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Starts or stops recording - recorded data is kept until reset()
+// 
+// #Params
+//   time_b: also time each expression - only with the expression hook
+
+void SkUEHeatMap::enable(bool enable_b, bool time_b)
+  {
+  #if (SKOOKUM & SK_DEBUG)
+    ms_is_enabled    = enable_b;
+    ms_is_timed      = enable_b && time_b;
+    ms_last_cell_idx = INDEX_NONE;
+
+    #if defined(SKDEBUG_HOOKS)
+      SkDebug::set_hook_expr(enable_b ? &SkUEHeatMap::on_expression : nullptr);
+      SkDebug::ms_expr_hook_flag = enable_b ? SkDebugInfo::Flag_debug_enabled : 0u;
+    #else
+      if (time_b)
+        {
+        UE_LOG(LogSkookum, Warning, TEXT("Expression timing needs a SkookumScript library built with SKDEBUG_HOOKS - only recording coroutine residency."));
+        }
+    #endif
+
+    UE_LOG(LogSkookum, Display, TEXT("SkookumScript heat map %s."), enable_b ? TEXT("started") : TEXT("stopped"));
+  #else
+    UE_LOG(LogSkookum, Warning, TEXT("The SkookumScript heat map needs expression debug info which is not present in this build configuration."));
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+// Discards everything recorded so far
+
+void SkUEHeatMap::reset()
+  {
+  ms_cells.Reset();
+  ms_cell_map.Reset();
+  ms_cell_name_map.Reset();
+  ms_last_cell_idx = INDEX_NONE;
+  }
+
+//---------------------------------------------------------------------------------------
+// Called when invokables are about to be freed or replaced (e.g. on live update or when
+// the compiled binaries are reloaded). Recorded cells are kept and matched up again by
+// file name.
+
+void SkUEHeatMap::forget_invokables()
+  {
+  ms_cell_map.Reset();
+  ms_last_cell_idx = INDEX_NONE;
+  }
+
+//---------------------------------------------------------------------------------------
+// Adds `count` executions and `cycles` time to the expression at `source_idx` of the
+// routine `invokable_p`
+
+void SkUEHeatMap::record(const SkInvokableBase * invokable_p, uint32_t source_idx, int64 count, uint64 cycles)
+  {
+  Key key{invokable_p, source_idx};
+
+  int32 cell_idx;
+  if (const int32 * cell_idx_p = ms_cell_map.Find(key))
+    {
+    cell_idx = *cell_idx_p;
+    }
+  else
+    {
+    // First time since the invokables were forgotten - resolve file and merge by it
+    FString class_name(TEXT("?"));
+    FString file_title(TEXT("?"));
+    #if defined(SK_AS_STRINGS) && (SKOOKUM & SK_DEBUG)
+      SkMemberInfo member_info(SkQualifier(*invokable_p), invokable_p->get_member_type(), invokable_p->is_class_member());
+      class_name = FString(invokable_p->get_scope()->get_name_cstr_dbg());
+      file_title = AStringToFString(member_info.as_file_title(SkMemberInfo::PathFlag__file));
+    #endif
+
+    FString full_name = FString::Printf(TEXT("%s/%s#%u"), *class_name, *file_title, source_idx);
+    if (const int32 * cell_idx_p = ms_cell_name_map.Find(full_name))
+      {
+      cell_idx = *cell_idx_p;
+      }
+    else
+      {
+      cell_idx = ms_cells.AddZeroed();
+      Cell & cell = ms_cells[cell_idx];
+      cell.m_class_name = class_name;
+      cell.m_file_title = file_title;
+      cell.m_source_idx = source_idx;
+      ms_cell_name_map.Add(full_name, cell_idx);
+      }
+    ms_cell_map.Add(key, cell_idx);
+    }
+
+  Cell & cell = ms_cells[cell_idx];
+  cell.m_count  += count;
+  cell.m_cycles += cycles;
+  ms_last_cell_idx = cell_idx;
+  }
+
+//---------------------------------------------------------------------------------------
+// Counts every call site the scheduled coroutines are currently waiting on - the
+// coroutine itself, the coroutine that called it and so on up the call chain
+
+void SkUEHeatMap::sample_coroutines_internal()
+  {
+  #if (SKOOKUM & SK_DEBUG)
+    const AList<SkMind> & minds = SkMind::get_updating_minds();
+    for (SkMind * mind_p = minds.get_first_null(); mind_p; mind_p = minds.get_next_null(mind_p))
+      {
+      AList<SkInvokedCoroutine> & icoroutines = mind_p->get_invoked_coroutines();
+      for (SkInvokedCoroutine * icoro_p = icoroutines.get_first_null(); icoro_p; icoro_p = icoroutines.get_next_null(icoro_p))
+        {
+        const SkInvokedContextBase * context_p = icoro_p;
+        const SkInvokedContextBase * caller_p  = context_p->get_caller_context();
+        while (caller_p)
+          {
+          // Skip calls made from C++ which have no source position
+          if ((context_p->m_debug_info & SkDebugInfo::Flag_origin__mask) == SkDebugInfo::Flag_origin_source
+            && context_p->m_source_idx != SkExpr_char_pos_invalid)
+            {
+            record(caller_p->get_invokable(), context_p->m_source_idx);
+            }
+          context_p = caller_p;
+          caller_p  = context_p->get_caller_context();
+          }
+        }
+      }
+
+    // Time between updates does not belong to the last sampled call site
+    ms_last_cell_idx = INDEX_NONE;
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+// Expression hook - counts the expression and, when timed, charges the time since the
+// previous expression to that previous expression
+
+void SkUEHeatMap::on_expression(SkExpressionBase * expr_p, SkObjectBase * scope_p, SkInvokedBase * caller_p)
+  {
+  #if (SKOOKUM & SK_DEBUG)
+    SkInvokedContextBase * context_p = caller_p ? caller_p->get_scope_context() : nullptr;
+    if (!context_p || !expr_p->is_valid_origin_source())
+      {
+      return;
+      }
+
+    if (ms_is_timed)
+      {
+      uint64 cycles = FPlatformTime::Cycles64();
+      if (ms_cells.IsValidIndex(ms_last_cell_idx))
+        {
+        ms_cells[ms_last_cell_idx].m_cycles += cycles - ms_last_cycles;
+        }
+      ms_last_cycles = cycles;
+      }
+
+    record(context_p->get_invokable(), expr_p->m_source_idx);
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+// Looks for the script file of a routine in the script overlays next to the project
+// files and returns the character index each of its lines starts at
+
+bool SkUEHeatMap::find_script_file(const FString & class_name, const FString & file_title, TArray<int32> * line_starts_p)
+  {
+  TArray<FString> roots;
+  #if (SKOOKUM & SK_DEBUG)
+    if (!SkBrain::ms_project_path.is_empty())
+      {
+      roots.Add(FPaths::GetPath(AStringToFString(SkBrain::ms_project_path)));
+      }
+    if (!SkBrain::ms_default_project_path.is_empty())
+      {
+      roots.AddUnique(FPaths::GetPath(AStringToFString(SkBrain::ms_default_project_path)));
+      }
+  #endif
+
+  for (const FString & root : roots)
+    {
+    TArray<FString> file_paths;
+    IFileManager::Get().FindFilesRecursive(file_paths, *root, *file_title, true, false);
+    for (const FString & file_path : file_paths)
+      {
+      // Class folders are either named after the class or flattened as `Super.Class`
+      FString folder_name = FPaths::GetCleanFilename(FPaths::GetPath(file_path));
+      if (folder_name != class_name && !folder_name.EndsWith(TEXT(".") + class_name))
+        {
+        continue;
+        }
+
+      FString source;
+      if (!FFileHelper::LoadFileToString(source, *file_path))
+        {
+        continue;
+        }
+
+      line_starts_p->Reset();
+      line_starts_p->Add(0);
+      for (int32 char_idx = 0; char_idx < source.Len(); ++char_idx)
+        {
+        if (source[char_idx] == TEXT('\n'))
+          {
+          line_starts_p->Add(char_idx + 1);
+          }
+        }
+      return true;
+      }
+    }
+
+  return false;
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes one line per script file line (or per character index if the file could not be
+// found) sorted by file and position
+
+bool SkUEHeatMap::export_csv(const FString & path)
+  {
+  struct Row
+    {
+    FString  m_file;
+    int32    m_line;
+    uint32_t m_source_idx;
+    int64    m_count;
+    uint64   m_cycles;
+    };
+
+  TMap<FString, TArray<int32>> file_lines;
+  TMap<FString, int32>         row_map;
+  TArray<Row>                  rows;
+
+  for (const Cell & cell : ms_cells)
+    {
+    FString file = cell.m_class_name / cell.m_file_title;
+
+    TArray<int32> * line_starts_p = file_lines.Find(file);
+    if (!line_starts_p)
+      {
+      line_starts_p = &file_lines.Add(file);
+      find_script_file(cell.m_class_name, cell.m_file_title, line_starts_p);
+      }
+
+    // Line numbers are 1-based, 0 means the file was not found
+    int32 line = 0;
+    if (line_starts_p->Num())
+      {
+      line = Algo::UpperBound(*line_starts_p, int32(cell.m_source_idx));
+      }
+
+    FString row_name = line ? FString::Printf(TEXT("%s:%d"), *file, line) : FString::Printf(TEXT("%s#%u"), *file, cell.m_source_idx);
+    int32 * row_idx_p = row_map.Find(row_name);
+    if (!row_idx_p)
+      {
+      row_idx_p = &row_map.Add(row_name, rows.AddZeroed());
+      Row & row = rows[*row_idx_p];
+      row.m_file = file;
+      row.m_line = line;
+      row.m_source_idx = cell.m_source_idx;
+      }
+
+    Row & row = rows[*row_idx_p];
+    row.m_count  += cell.m_count;
+    row.m_cycles += cell.m_cycles;
+    row.m_source_idx = FMath::Min(row.m_source_idx, cell.m_source_idx);
+    }
+
+  rows.Sort([](const Row & lhs, const Row & rhs)
+    {
+    int32 order = lhs.m_file.Compare(rhs.m_file);
+    return order ? (order < 0) : (lhs.m_source_idx < rhs.m_source_idx);
+    });
+
+  double ms_per_cycle = FPlatformTime::GetSecondsPerCycle64() * 1000.0;
+
+  FString csv(TEXT("file,line,char_idx,count,ms\n"));
+  for (const Row & row : rows)
+    {
+    csv += FString::Printf(TEXT("\"%s\",%d,%u,%lld,%.4f\n"), *row.m_file.Replace(TEXT("\""), TEXT("\"\"")), row.m_line, row.m_source_idx, row.m_count, double(row.m_cycles) * ms_per_cycle);
+    }
+
+  return FFileHelper::SaveStringToFile(csv, *path);
+  }
@@ -0,0 +1,116 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Per-expression execution heat map of script routines
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+class SkExpressionBase;
+class SkInvokableBase;
+class SkInvokedBase;
+class SkObjectBase;
+
+//---------------------------------------------------------------------------------------
+// Side table of execution counts (and optionally time) keyed by invokable and expression
+// source index, exported per script file and line to find hot spots inside routines.
+//
+// These sources feed it:
+//   - Expression hook: exact per-expression counts plus, if requested, the time until
+//     the next expression executes. Needs a SkookumScript library built with
+//     SKDEBUG_HOOKS since that is where SkDebug::set_hook_expr() lives.
+//   - Coroutine residency: after each update the call chains of all scheduled coroutines
+//     are walked and each call site they are waiting on is counted once per frame. Works
+//     in any build with SK_DEBUG (i.e. Development) and finds hot durational loops.
+//   - Call stack sampler (see SkUEScriptSampler): each sample counts the innermost call
+//     site with a known position, i.e. where the leaf routine was called from.
+//
+// Toggled and exported with the `Sk.HeatMap` console command.
+class SkUEHeatMap
+  {
+  public:
+
+  // Nested Structures
+
+    struct Cell
+      {
+      FString  m_class_name;
+      FString  m_file_title;
+      uint32_t m_source_idx;
+      int64    m_count;
+      uint64   m_cycles;
+      };
+
+  // Class Methods
+
+    static bool is_enabled()                     { return ms_is_enabled; }
+    static void enable(bool enable_b = true, bool time_b = false);
+    static void reset();
+    static void forget_invokables();
+
+    static void record(const SkInvokableBase * invokable_p, uint32_t source_idx, int64 count = 1, uint64 cycles = 0u);
+    static void sample_coroutines()              { if (ms_is_enabled) { sample_coroutines_internal(); } }
+
+    static const TArray<Cell> & get_cells()      { return ms_cells; }
+
+    static bool export_csv(const FString & path);
+
+    // Also used to turn source indexes into line numbers by SkUEAllocationTracer
+    static bool find_script_file(const FString & class_name, const FString & file_title, TArray<int32> * line_starts_p);
+
+  protected:
+
+  // Internal Structures
+
+    struct Key
+      {
+      const SkInvokableBase * m_invokable_p;
+      uint32_t                m_source_idx;
+
+      bool operator==(const Key & other) const  { return m_invokable_p == other.m_invokable_p && m_source_idx == other.m_source_idx; }
+      friend uint32 GetTypeHash(const Key & key) { return HashCombine(PointerHash(key.m_invokable_p), key.m_source_idx); }
+      };
+
+  // Internal Class Methods
+
+    static void sample_coroutines_internal();
+    static void on_expression(SkExpressionBase * expr_p, SkObjectBase * scope_p, SkInvokedBase * caller_p);
+
+  // Class Data Members
+
+    static bool                 ms_is_enabled;
+    static bool                 ms_is_timed;
+    static TArray<Cell>         ms_cells;
+    static TMap<Key, int32>     ms_cell_map;
+    static TMap<FString, int32> ms_cell_name_map;
+    static int32                ms_last_cell_idx;
+    static uint64               ms_last_cycles;
+
+  };  // SkUEHeatMap
@@ -0,0 +1,210 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Memoized lookup of inherited methods and coroutines by name
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEMemberLookup.hpp"
+#include "SkUECostAttribution.hpp"
+#include "SkUEDemandLoadManager.hpp"
+#include "SkUEScriptProfiler.hpp"
+#include "SkUEScriptReplay.hpp"
+
+#include <SkookumScript/SkCoroutine.hpp>
+#include <SkookumScript/SkDebug.hpp>
+#include <SkookumScript/SkInvokedCoroutine.hpp>
+#include <SkookumScript/SkInvokedMethod.hpp>
+#include <SkookumScript/SkMethod.hpp>
+
+//=======================================================================================
+// SkUEMemberLookup Class Data
+//=======================================================================================
+
+TMap<SkUEMemberLookup::Key, SkUEMemberLookup::Entry> SkUEMemberLookup::ms_cache;
+SkUEMemberLookup::Stats SkUEMemberLookup::ms_stats;
+
+//=======================================================================================
+// SkUEMemberLookup Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Same as SkClass::find_method_inherited()
+
+SkMethodBase * SkUEMemberLookup::find_method_inherited(SkClass * class_p, const ASymbol & method_name, bool * is_class_member_p)
+  {
+  return static_cast<SkMethodBase *>(find(class_p, method_name, Kind_method, is_class_member_p, 
+    [class_p, &method_name](bool * is_class_member_p) { return class_p->find_method_inherited(method_name, is_class_member_p); }));
+  }
+
+//---------------------------------------------------------------------------------------
+// Same as SkClass::find_instance_method_inherited()
+
+SkMethodBase * SkUEMemberLookup::find_instance_method_inherited(SkClass * class_p, const ASymbol & method_name)
+  {
+  return static_cast<SkMethodBase *>(find(class_p, method_name, Kind_instance_method, nullptr,
+    [class_p, &method_name](bool *) { return class_p->find_instance_method_inherited(method_name); }));
+  }
+
+//---------------------------------------------------------------------------------------
+// Same as SkClass::find_coroutine_inherited()
+
+SkCoroutineBase * SkUEMemberLookup::find_coroutine_inherited(SkClass * class_p, const ASymbol & coroutine_name)
+  {
+  return static_cast<SkCoroutineBase *>(find(class_p, coroutine_name, Kind_coroutine, nullptr,
+    [class_p, &coroutine_name](bool *) { return class_p->find_coroutine_inherited(coroutine_name); }));
+  }
+
+//---------------------------------------------------------------------------------------
+// Same as SkInstance::method_call() but with memoized method lookup. The receiver must be
+// a regular object - closures and metaclasses have their own method_call() behavior.
+// 
+// #Params
+//   args_pp: arguments - with their reference counts incremented - or nullptr
+void SkUEMemberLookup::method_call(
+  SkInstance *    receiver_p,
+  const ASymbol & method_name,
+  SkInstance **   args_pp,
+  uint32_t        arg_count,
+  SkInstance **   result_pp, // = nullptr
+  SkInvokedBase * caller_p   // = nullptr
+  )
+  {
+  SkUEScriptReplay::CallScope replay(receiver_p, method_name, args_pp, arg_count);
+
+  SkClass * class_p = receiver_p->get_class();
+  bool is_class_member = false;
+  SkMethodBase * method_p = find_method_inherited(class_p, method_name, &is_class_member);
+  if (!method_p)
+    {
+    // Let the runtime deal with the missing method
+    receiver_p->method_call(method_name, args_pp, arg_count, result_pp, caller_p);
+    return;
+    }
+
+  SkObjectBase * scope_p = is_class_member ? static_cast<SkObjectBase *>(&class_p->get_metaclass()) : receiver_p;
+  SkInvokedMethod imethod(caller_p, scope_p, method_p, a_stack_allocate(method_p->get_invoked_data_array_size(), SkInstance*));
+
+  SKDEBUG_ICALL_SET_INTERNAL(&imethod);
+  SKDEBUG_HOOK_SCRIPT_ENTRY(method_name);
+
+  imethod.data_append_args(args_pp, arg_count, method_p->get_params());
+  SkUEScriptProfiler::Scope profile(method_p, &imethod, SkUEScriptProfiler::Origin_callback);
+  SkUECostAttribution::Scope cost(&imethod);
+  method_p->invoke(&imethod, caller_p, result_pp);
+
+  SKDEBUG_HOOK_SCRIPT_EXIT();
+  }
+
+//---------------------------------------------------------------------------------------
+// Same as SkInstance::method_call() with 0/1 arguments but with memoized method lookup
+
+void SkUEMemberLookup::method_call(SkInstance * receiver_p, const ASymbol & method_name, SkInstance * arg_p, SkInstance ** result_pp)
+  {
+  method_call(receiver_p, method_name, &arg_p, arg_p ? 1u : 0u, result_pp);
+  }
+
+//---------------------------------------------------------------------------------------
+// Same as SkInstance::coroutine_call() invoked immediately but with memoized coroutine
+// lookup - e.g. for engine side code starting a coroutine by name every frame.
+// 
+// #Params
+//   args_pp: arguments - with their reference counts incremented - or nullptr
+//   
+// #Returns
+//   nullptr if the coroutine completed immediately or the invoked coroutine if it has a
+//   deferred completion
+SkInvokedCoroutine * SkUEMemberLookup::coroutine_call(
+  SkInstance *    receiver_p,
+  const ASymbol & coroutine_name,
+  SkInstance **   args_pp,   // = nullptr
+  uint32_t        arg_count, // = 0u
+  SkInvokedBase * caller_p,  // = nullptr
+  SkMind *        updater_p  // = nullptr
+  )
+  {
+  SkCoroutineBase * coroutine_p = find_coroutine_inherited(receiver_p->get_class(), coroutine_name);
+  if (!coroutine_p)
+    {
+    // Let the runtime deal with the missing coroutine
+    return receiver_p->coroutine_call(coroutine_name, args_pp, arg_count, true, SkCall_interval_always, caller_p, updater_p);
+    }
+
+  SkInvokedCoroutine * icoroutine_p = SkInvokedCoroutine::pool_new(coroutine_p);
+  icoroutine_p->reset(SkCall_interval_always, caller_p, receiver_p, updater_p, nullptr);
+  icoroutine_p->data_append_args(args_pp, arg_count, coroutine_p->get_params());
+
+  return icoroutine_p->on_update() ? nullptr : icoroutine_p;
+  }
+
+//---------------------------------------------------------------------------------------
+// Forget all lookups - call whenever classes or their routines change (live update,
+// reloading of compiled binaries, shutdown)
+
+void SkUEMemberLookup::invalidate()
+  {
+  if (ms_cache.Num())
+    {
+    ms_cache.Reset();
+    ms_stats.m_invalidations++;
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+
+template<typename _LookupType>
+SkInvokableBase * SkUEMemberLookup::find(SkClass * class_p, const ASymbol & name, eKind kind, bool * is_class_member_p, _LookupType && lookup)
+  {
+  Key key = { class_p, name.get_id(), uint32_t(kind) };
+  const Entry * entry_p = ms_cache.Find(key);
+  if (entry_p)
+    {
+    ms_stats.m_hits++;
+    if (is_class_member_p)
+      {
+      *is_class_member_p = entry_p->m_is_class_member;
+      }
+    return entry_p->m_invokable_p;
+    }
+
+  ms_stats.m_misses++;
+  bool is_class_member = false;
+  SkInvokableBase * invokable_p = lookup(&is_class_member);
+  if (is_class_member_p)
+    {
+    *is_class_member_p = is_class_member;
+    }
+
+  // Routines of demand-loaded classes go away when their group is unloaded
+  if (!class_p->get_demand_loaded_root())
+    {
+    ms_cache.Add(key, { invokable_p, is_class_member });
+    }
+  else
+    {
+    // About to be called so the group is in use
+    SkUEDemandLoadManager::get()->touch(*class_p);
+    }
+
+  return invokable_p;
+  }
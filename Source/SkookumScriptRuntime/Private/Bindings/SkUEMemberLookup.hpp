@@ -0,0 +1,107 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Memoized lookup of inherited methods and coroutines by name
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "Containers/Map.h"
+
+#include <SkookumScript/SkClass.hpp>
+
+class SkInvokedBase;
+class SkInvokedCoroutine;
+class SkMind;
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Remembers the results of by-name lookups of inherited routines so that repeated
+// dynamic invocations (e.g. component callbacks, constructor/destructor queries, engine
+// side coroutine calls by name) cost a single hash lookup instead of a binary search in each class up the superclass chain.
+//
+// Entries are keyed by (class, name id, kind) and also remember failed lookups. Routines
+// of demand-loaded classes are not memoized since they come and go with their class
+// group. Everything is forgotten on live update - see invalidate().
+class SkUEMemberLookup
+  {
+  public:
+
+    struct Stats
+      {
+      uint32_t m_hits;
+      uint32_t m_misses;
+      uint32_t m_invalidations;
+      };
+
+  // Class Methods
+
+    static SkMethodBase *    find_method_inherited(SkClass * class_p, const ASymbol & method_name, bool * is_class_member_p = nullptr);
+    static SkMethodBase *    find_instance_method_inherited(SkClass * class_p, const ASymbol & method_name);
+    static SkCoroutineBase * find_coroutine_inherited(SkClass * class_p, const ASymbol & coroutine_name);
+
+    static void              method_call(SkInstance * receiver_p, const ASymbol & method_name, SkInstance ** args_pp, uint32_t arg_count, SkInstance ** result_pp = nullptr, SkInvokedBase * caller_p = nullptr);
+    static void              method_call(SkInstance * receiver_p, const ASymbol & method_name, SkInstance * arg_p = nullptr, SkInstance ** result_pp = nullptr);
+    static SkInvokedCoroutine * coroutine_call(SkInstance * receiver_p, const ASymbol & coroutine_name, SkInstance ** args_pp = nullptr, uint32_t arg_count = 0u, SkInvokedBase * caller_p = nullptr, SkMind * updater_p = nullptr);
+
+    static void              invalidate();
+    static const Stats &     get_stats() { return ms_stats; }
+
+  protected:
+
+    enum eKind
+      {
+      Kind_method,            // Instance method, or class method if no instance method
+      Kind_instance_method,
+      Kind_coroutine
+      };
+
+    struct Key
+      {
+      SkClass * m_class_p;
+      uint32_t  m_name_id;
+      uint32_t  m_kind;
+
+      bool operator==(const Key & other) const { return m_class_p == other.m_class_p && m_name_id == other.m_name_id && m_kind == other.m_kind; }
+      friend uint32 GetTypeHash(const Key & key) { return HashCombine(GetTypeHash(key.m_class_p), key.m_name_id ^ (key.m_kind << 30u)); }
+      };
+
+    struct Entry
+      {
+      SkInvokableBase * m_invokable_p;  // nullptr if not found
+      bool              m_is_class_member;
+      };
+
+    template<typename _LookupType>
+    static SkInvokableBase * find(SkClass * class_p, const ASymbol & name, eKind kind, bool * is_class_member_p, _LookupType && lookup);
+
+  // Class Data Members
+
+    static TMap<Key, Entry> ms_cache;
+    static Stats            ms_stats;
+
+  };  // SkUEMemberLookup
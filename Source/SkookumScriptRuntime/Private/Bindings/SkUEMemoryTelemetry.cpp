@@ -0,0 +1,372 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Per-frame history of script object pools and script memory
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEMemoryTelemetry.hpp"
+#include "ISkookumScriptRuntime.h"
+#include "SkUEDemandLoadManager.hpp"
+#include "SkUEUtils.hpp"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include <AgogCore/ABinaryParse.hpp>
+#include <AgogCore/AStringRef.hpp>
+#include <AgogCore/ASymbol.hpp>
+#include <SkookumScript/SkDataInstance.hpp>
+#include <SkookumScript/SkInvokedCoroutine.hpp>
+#include <SkookumScript/SkMind.hpp>
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+namespace
+  {
+
+  //---------------------------------------------------------------------------------------
+  // Sk.Memory start|stop|reset|history <frames>|export [path]
+  void memory_command(const TArray<FString> & args)
+    {
+    FString command = args.Num() ? args[0] : FString(TEXT("export"));
+
+    if (command == TEXT("start"))
+      {
+      SkUEMemoryTelemetry::enable(true);
+      }
+    else if (command == TEXT("stop"))
+      {
+      SkUEMemoryTelemetry::enable(false);
+      }
+    else if (command == TEXT("reset"))
+      {
+      SkUEMemoryTelemetry::reset();
+      }
+    else if ((command == TEXT("history")) && (args.Num() > 1))
+      {
+      SkUEMemoryTelemetry::set_history_length(FCString::Atoi(*args[1]));
+      }
+    else if (command == TEXT("export"))
+      {
+      FString path = (args.Num() > 1)
+        ? args[1]
+        : FPaths::ProfilingDir() / TEXT("SkookumScript") / (TEXT("Memory-") + FDateTime::Now().ToString() + TEXT(".csv"));
+      if (SkUEMemoryTelemetry::export_csv(path))
+        {
+        UE_LOG(LogSkookum, Display, TEXT("Wrote SkookumScript memory telemetry to '%s'."), *path);
+        }
+      else
+        {
+        UE_LOG(LogSkookum, Warning, TEXT("Unable to write SkookumScript memory telemetry to '%s'."), *path);
+        }
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Unknown Sk.Memory command '%s' - use start, stop, reset, history <frames> or export."), *command);
+      }
+    }
+
+  FAutoConsoleCommand s_memory_cmd(
+    TEXT("Sk.Memory"),
+    TEXT("SkookumScript memory telemetry: 'Sk.Memory start|stop|reset', 'Sk.Memory history <frames>' to set how many frames are kept or 'Sk.Memory export [path]' to write them as CSV."),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&memory_command));
+
+  //---------------------------------------------------------------------------------------
+  void name_as_binary(const FString & name, void ** binary_pp)
+    {
+    FStringToAString(name).as_binary(binary_pp);
+    }
+
+  } // End unnamed namespace
+
+//=======================================================================================
+// SkUEMemoryTelemetry Class Data
+//=======================================================================================
+
+#if (SKOOKUM & SK_DEBUG)
+  bool                                SkUEMemoryTelemetry::ms_is_enabled = true;
+#else
+  bool                                SkUEMemoryTelemetry::ms_is_enabled = false;
+#endif
+TArray<SkUEMemoryTelemetry::Pool>     SkUEMemoryTelemetry::ms_pools;
+TArray<FString>                       SkUEMemoryTelemetry::ms_pool_names;
+TMap<uint32, FString>                 SkUEMemoryTelemetry::ms_mind_names;
+TArray<SkUEMemoryTelemetry::Frame>    SkUEMemoryTelemetry::ms_history;
+int32                                 SkUEMemoryTelemetry::ms_history_next;
+int32                                 SkUEMemoryTelemetry::ms_history_count;
+
+//=======================================================================================
+// SkUEMemoryTelemetry Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Sets how many of the most recent frames are kept - discards the current history
+
+void SkUEMemoryTelemetry::set_history_length(int32 frames)
+  {
+  ms_history.Empty(FMath::Max(frames, 1));
+  ms_history.SetNum(FMath::Max(frames, 1));
+  reset();
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEMemoryTelemetry::reset()
+  {
+  ms_history_next  = 0;
+  ms_history_count = 0;
+  }
+
+//---------------------------------------------------------------------------------------
+// Returns the frame `age` frames before the most recent one or nullptr if it is not in
+// the history
+
+const SkUEMemoryTelemetry::Frame * SkUEMemoryTelemetry::get_frame(int32 age)
+  {
+  if (age < 0 || age >= ms_history_count)
+    {
+    return nullptr;
+    }
+
+  int32 length = ms_history.Num();
+  return &ms_history[(ms_history_next - 1 - age + length) % length];
+  }
+
+//---------------------------------------------------------------------------------------
+
+const FString & SkUEMemoryTelemetry::get_mind_name(uint32_t name_id)
+  {
+  const FString * name_p = ms_mind_names.Find(name_id);
+  return name_p ? *name_p : FString::GetEmpty();
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEMemoryTelemetry::register_core_pools()
+  {
+  register_pool(TEXT("AStringRef"), AStringRef::get_pool());
+  register_pool(TEXT("ASymbolRef"), ASymbolRef::get_pool());
+  register_pool(TEXT("SkInstance"), SkInstance::get_pool());
+  register_pool(TEXT("SkDataInstance"), SkDataInstance::get_pool());
+  register_pool(TEXT("SkInvokedExpression"), SkInvokedExpression::get_pool());
+  register_pool(TEXT("SkInvokedCoroutine"), SkInvokedCoroutine::get_pool());
+  }
+
+//---------------------------------------------------------------------------------------
+// Gets the current usage of all registered pools in the order of get_pool_names() -
+// whether or not telemetry is enabled
+
+void SkUEMemoryTelemetry::sample_pools(TArray<PoolSample> * samples_p)
+  {
+  if (!ms_pools.Num())
+    {
+    register_core_pools();
+    }
+
+  int32 pool_count = ms_pools.Num();
+  samples_p->SetNumUninitialized(pool_count, false);
+  for (int32 pool_idx = 0; pool_idx < pool_count; ++pool_idx)
+    {
+    const Pool & pool = ms_pools[pool_idx];
+    (*pool.m_sample_f)(pool.m_pool_p, &(*samples_p)[pool_idx]);
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Records the current frame into the history - called once per frame after the update
+
+void SkUEMemoryTelemetry::sample_internal()
+  {
+  if (!ms_history.Num())
+    {
+    set_history_length(History_length_default);
+    }
+
+  Frame & frame = ms_history[ms_history_next];
+  frame.m_frame   = GFrameCounter;
+  frame.m_seconds = FPlatformTime::Seconds();
+
+  sample_pools(&frame.m_pools);
+
+  // Coroutines per mind
+  frame.m_minds.Reset();
+  frame.m_coroutines = 0u;
+  const AList<SkMind> & minds = SkMind::get_updating_minds();
+  for (SkMind * mind_p = minds.get_first_null(); mind_p; mind_p = minds.get_next_null(mind_p))
+    {
+    const ASymbol & name = mind_p->get_name();
+    uint32_t name_id = name.get_id();
+    if (!ms_mind_names.Contains(name_id))
+      {
+      ms_mind_names.Add(name_id, AStringToFString(name.as_string()));
+      }
+
+    uint32_t coroutines = mind_p->get_invoked_coroutines().get_count();
+    frame.m_minds.Add({name_id, coroutines});
+    frame.m_coroutines += coroutines;
+    }
+
+  // Demand-loaded classes
+  SkUEDemandLoadManager * demand_load_manager_p = SkUEDemandLoadManager::get();
+  frame.m_demand_groups_loaded = demand_load_manager_p ? demand_load_manager_p->get_stats().m_groups_loaded : 0u;
+  frame.m_demand_bytes_loaded  = demand_load_manager_p ? demand_load_manager_p->get_stats().m_bytes_loaded : 0u;
+
+  ms_history_next  = (ms_history_next + 1) % ms_history.Num();
+  ms_history_count = FMath::Min(ms_history_count + 1, ms_history.Num());
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes one row per frame in the history - oldest first. Each mind seen in the history
+// gets its own coroutine column.
+
+bool SkUEMemoryTelemetry::export_csv(const FString & path)
+  {
+  // Gather mind columns
+  TArray<uint32> mind_ids;
+  for (int32 age = ms_history_count - 1; age >= 0; --age)
+    {
+    for (const MindSample & mind : get_frame(age)->m_minds)
+      {
+      mind_ids.AddUnique(mind.m_name_id);
+      }
+    }
+
+  FString csv(TEXT("Frame,Seconds"));
+  for (const FString & pool_name : ms_pool_names)
+    {
+    csv += FString::Printf(TEXT(",%s Used,%s Max,%s Overflow,%s Bytes"), *pool_name, *pool_name, *pool_name, *pool_name);
+    }
+  csv += TEXT(",Coroutines,Demand Groups Loaded,Demand Bytes Loaded");
+  for (uint32 mind_id : mind_ids)
+    {
+    csv += FString::Printf(TEXT(",\"%s Coroutines\""), *get_mind_name(mind_id).Replace(TEXT("\""), TEXT("\"\"")));
+    }
+  csv += TEXT("\n");
+
+  for (int32 age = ms_history_count - 1; age >= 0; --age)
+    {
+    const Frame & frame = *get_frame(age);
+
+    csv += FString::Printf(TEXT("%llu,%.4f"), frame.m_frame, frame.m_seconds);
+    for (const PoolSample & pool : frame.m_pools)
+      {
+      csv += FString::Printf(TEXT(",%u,%u,%u,%u"), pool.m_count_used, pool.m_count_max, pool.m_count_overflow, pool.m_bytes);
+      }
+    csv += FString::Printf(TEXT(",%u,%u,%u"), frame.m_coroutines, frame.m_demand_groups_loaded, frame.m_demand_bytes_loaded);
+    for (uint32 mind_id : mind_ids)
+      {
+      const MindSample * mind_p = frame.m_minds.FindByPredicate([mind_id](const MindSample & mind) { return mind.m_name_id == mind_id; });
+      csv += FString::Printf(TEXT(",%u"), mind_p ? mind_p->m_coroutines : 0u);
+      }
+    csv += TEXT("\n");
+    }
+
+  return FFileHelper::SaveStringToFile(csv, *path);
+  }
+
+//---------------------------------------------------------------------------------------
+// Binary length of the most recent frame - see as_binary()
+
+uint32_t SkUEMemoryTelemetry::as_binary_length()
+  {
+  const Frame * frame_p = get_frame();
+  if (!frame_p)
+    {
+    return 4u;
+    }
+
+  uint32_t length = 4u + 8u + 4u + 4u + 4u + 4u + 4u;
+  for (const FString & pool_name : ms_pool_names)
+    {
+    length += FStringToAString(pool_name).as_binary_length() + 16u;
+    }
+  for (const MindSample & mind : frame_p->m_minds)
+    {
+    length += FStringToAString(get_mind_name(mind.m_name_id)).as_binary_length() + 4u;
+    }
+  return length;
+  }
+
+//---------------------------------------------------------------------------------------
+// Fills memory pointed to by binary_pp with the most recent frame and increments the
+// memory address to just past the last byte written.
+//
+// Binary composition:
+//   4 bytes - frame count in history (0 if empty and nothing else follows)
+//   8 bytes - frame number
+//   4 bytes - coroutines
+//   4 bytes - demand-loaded groups loaded
+//   4 bytes - demand-loaded bytes loaded
+//   4 bytes - pool count
+//   n bytes - pool name string } Repeating
+//   4 bytes - count used       }
+//   4 bytes - count max        }
+//   4 bytes - count overflow   }
+//   4 bytes - bytes used       }
+//   4 bytes - mind count
+//   n bytes - mind name string } Repeating
+//   4 bytes - coroutines       }
+
+void SkUEMemoryTelemetry::as_binary(void ** binary_pp)
+  {
+  uint32_t frame_count = uint32_t(ms_history_count);
+  A_BYTE_STREAM_OUT32(binary_pp, &frame_count);
+
+  const Frame * frame_p = get_frame();
+  if (!frame_p)
+    {
+    return;
+    }
+
+  uint64_t frame_number = frame_p->m_frame;
+  A_BYTE_STREAM_OUT64(binary_pp, &frame_number);
+  A_BYTE_STREAM_OUT32(binary_pp, &frame_p->m_coroutines);
+  A_BYTE_STREAM_OUT32(binary_pp, &frame_p->m_demand_groups_loaded);
+  A_BYTE_STREAM_OUT32(binary_pp, &frame_p->m_demand_bytes_loaded);
+
+  uint32_t pool_count = uint32_t(frame_p->m_pools.Num());
+  A_BYTE_STREAM_OUT32(binary_pp, &pool_count);
+  for (uint32_t pool_idx = 0u; pool_idx < pool_count; ++pool_idx)
+    {
+    const PoolSample & pool = frame_p->m_pools[pool_idx];
+    name_as_binary(ms_pool_names[pool_idx], binary_pp);
+    A_BYTE_STREAM_OUT32(binary_pp, &pool.m_count_used);
+    A_BYTE_STREAM_OUT32(binary_pp, &pool.m_count_max);
+    A_BYTE_STREAM_OUT32(binary_pp, &pool.m_count_overflow);
+    A_BYTE_STREAM_OUT32(binary_pp, &pool.m_bytes);
+    }
+
+  uint32_t mind_count = uint32_t(frame_p->m_minds.Num());
+  A_BYTE_STREAM_OUT32(binary_pp, &mind_count);
+  for (const MindSample & mind : frame_p->m_minds)
+    {
+    name_as_binary(get_mind_name(mind.m_name_id), binary_pp);
+    A_BYTE_STREAM_OUT32(binary_pp, &mind.m_coroutines);
+    }
+  }
@@ -0,0 +1,167 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Per-frame history of script object pools and script memory
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+
+#include <AgogCore/AObjReusePool.hpp>
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Samples every registered object reuse pool, the coroutines of each mind and the memory
+// of the loaded demand-loaded class groups once per frame and keeps a rolling history
+// that can be queried in-process, exported as CSV (`Sk.Memory export`) or streamed to
+// the SkookumIDE (see SkUERemote - Command_memory / Command_memory_reply).
+//
+// The core pools (AStringRef, ASymbolRef, SkInstance, SkDataInstance,
+// SkInvokedExpression and SkInvokedCoroutine) are registered automatically - others can
+// be added with register_pool(). Pool usage counts are only tracked when the libraries
+// are built with AORPOOL_USAGE_COUNT (on with A_EXTRA_CHECK) and are zero otherwise.
+class SkUEMemoryTelemetry
+  {
+  public:
+
+  // Nested Structures
+
+    struct PoolSample
+      {
+      uint32_t m_count_used;
+      uint32_t m_count_max;
+      uint32_t m_count_overflow;
+      uint32_t m_bytes;
+      };
+
+    struct MindSample
+      {
+      uint32_t m_name_id;
+      uint32_t m_coroutines;
+      };
+
+    struct Frame
+      {
+      uint64              m_frame;
+      double              m_seconds;
+      TArray<PoolSample>  m_pools;  // In the order of get_pool_names()
+      TArray<MindSample>  m_minds;
+      uint32_t            m_coroutines;
+      uint32_t            m_demand_groups_loaded;
+      uint32_t            m_demand_bytes_loaded;
+      };
+
+  // Class Methods
+
+    template<class _ObjectType>
+    static void register_pool(const TCHAR * name_p, const AObjReusePool<_ObjectType> & pool);
+
+    static bool is_enabled()                          { return ms_is_enabled; }
+    static void enable(bool enable_b = true)          { ms_is_enabled = enable_b; }
+    static void set_history_length(int32 frames);
+    static void reset();
+
+    static void sample()                              { if (ms_is_enabled) { sample_internal(); } }
+    static void sample_pools(TArray<PoolSample> * samples_p);
+
+    static int32                   get_frame_count()  { return ms_history_count; }
+    static const Frame *           get_frame(int32 age = 0);
+    static const TArray<FString> & get_pool_names()   { return ms_pool_names; }
+    static const FString &         get_mind_name(uint32_t name_id);
+
+    static bool     export_csv(const FString & path);
+    static uint32_t as_binary_length();
+    static void     as_binary(void ** binary_pp);
+
+  protected:
+
+  // Internal Structures
+
+    enum
+      {
+      History_length_default = 600
+      };
+
+    struct Pool
+      {
+      const void * m_pool_p;
+      void      (* m_sample_f)(const void * pool_p, PoolSample * sample_p);
+      };
+
+  // Internal Class Methods
+
+    template<class _ObjectType>
+    static void sample_pool(const void * pool_p, PoolSample * sample_p);
+
+    static void register_core_pools();
+    static void sample_internal();
+
+  // Class Data Members
+
+    static bool                   ms_is_enabled;
+    static TArray<Pool>           ms_pools;
+    static TArray<FString>        ms_pool_names;
+    static TMap<uint32, FString>  ms_mind_names;
+
+    // Ring of the most recent frames - ms_history_next is where the next frame goes
+    static TArray<Frame>          ms_history;
+    static int32                  ms_history_next;
+    static int32                  ms_history_count;
+
+  };  // SkUEMemoryTelemetry
+
+
+//=======================================================================================
+// Inline Functions
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Adds a pool to be sampled from the next frame on - the pool must outlive the sampling
+template<class _ObjectType>
+inline void SkUEMemoryTelemetry::register_pool(const TCHAR * name_p, const AObjReusePool<_ObjectType> & pool)
+  {
+  // Frames already in the history have no entry for this pool
+  reset();
+
+  ms_pools.Add({&pool, &sample_pool<_ObjectType>});
+  ms_pool_names.Add(name_p);
+  }
+
+//---------------------------------------------------------------------------------------
+
+template<class _ObjectType>
+inline void SkUEMemoryTelemetry::sample_pool(const void * pool_p, PoolSample * sample_p)
+  {
+  const AObjReusePool<_ObjectType> & pool = *static_cast<const AObjReusePool<_ObjectType> *>(pool_p);
+
+  sample_p->m_count_used     = pool.get_count_used();
+  sample_p->m_count_max      = pool.get_count_max();
+  // The overflow looks at the initial block which only exists once something was allocated
+  sample_p->m_count_overflow = sample_p->m_count_max ? pool.get_count_overflow() : 0u;
+  sample_p->m_bytes          = pool.get_bytes_allocated();
+  }
@@ -0,0 +1,273 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Initial object pool sizes from the peak usage of earlier sessions
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEPoolProfile.hpp"
+#include "ISkookumScriptRuntime.h"
+#include "SkUEMemoryTelemetry.hpp"
+
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+namespace
+  {
+
+  // Objects added on top of a recorded peak as a fraction of it
+  const uint32_t c_headroom_divisor = 8u;
+
+  // Pools are never presized to less than this
+  const uint32_t c_min_init_size = 16u;
+
+  //---------------------------------------------------------------------------------------
+  // Sk.PoolProfile save [path]|merge [out path] [in paths...]
+  void pool_profile_command(const TArray<FString> & args)
+    {
+    FString command = args.Num() ? args[0] : FString(TEXT("save"));
+
+    if (command == TEXT("save"))
+      {
+      FString path = (args.Num() > 1) ? args[1] : SkUEPoolProfile::get_session_path();
+      if (SkUEPoolProfile::save_session(path))
+        {
+        UE_LOG(LogSkookum, Display, TEXT("Wrote SkookumScript pool profile to '%s'."), *path);
+        }
+      }
+    else if (command == TEXT("merge"))
+      {
+      FString out_path = (args.Num() > 1) ? args[1] : SkUEPoolProfile::get_profile_path();
+      TArray<FString> in_paths;
+      for (int32 arg_idx = 2; arg_idx < args.Num(); ++arg_idx)
+        {
+        in_paths.Add(args[arg_idx]);
+        }
+
+      // Default to all recorded sessions
+      if (!in_paths.Num())
+        {
+        FString session_dir = FPaths::GetPath(SkUEPoolProfile::get_session_path());
+        IFileManager::Get().FindFiles(in_paths, *(session_dir / TEXT("PoolProfile-*.json")), true, false);
+        for (FString & in_path : in_paths)
+          {
+          in_path = session_dir / in_path;
+          }
+        }
+
+      if (SkUEPoolProfile::merge(out_path, in_paths))
+        {
+        UE_LOG(LogSkookum, Display, TEXT("Merged %d SkookumScript pool profiles into '%s'."), in_paths.Num(), *out_path);
+        }
+      else
+        {
+        UE_LOG(LogSkookum, Warning, TEXT("Unable to merge SkookumScript pool profiles into '%s'."), *out_path);
+        }
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Unknown Sk.PoolProfile command '%s' - use save or merge."), *command);
+      }
+    }
+
+  FAutoConsoleCommand s_pool_profile_cmd(
+    TEXT("Sk.PoolProfile"),
+    TEXT("SkookumScript pool profile: 'Sk.PoolProfile save [path]' writes the pool peaks of this session, 'Sk.PoolProfile merge [out path] [in paths...]' combines session profiles (default all recorded sessions into the profile used to presize pools)."),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&pool_profile_command));
+
+  } // End unnamed namespace
+
+//=======================================================================================
+// SkUEPoolProfile Class Data
+//=======================================================================================
+
+TMap<FString, uint32> SkUEPoolProfile::ms_peaks;
+
+//=======================================================================================
+// SkUEPoolProfile Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Profile used to presize pools - in the project's Config folder so it gets staged with
+// packaged builds
+
+FString SkUEPoolProfile::get_profile_path()
+  {
+  return FPaths::ProjectConfigDir() / TEXT("SkookumScriptPoolProfile.json");
+  }
+
+//---------------------------------------------------------------------------------------
+// Where a recording session writes its peaks
+
+FString SkUEPoolProfile::get_session_path()
+  {
+  return FPaths::ProjectSavedDir() / TEXT("SkookumScript") / (TEXT("PoolProfile-") + FDateTime::Now().ToString() + TEXT(".json"));
+  }
+
+//---------------------------------------------------------------------------------------
+// Loads the profile that get_init_size() uses - quietly does nothing if there is none
+
+bool SkUEPoolProfile::load(const FString & path)
+  {
+  int32 sessions = 0;
+  ms_peaks.Reset();
+  return read(path, &ms_peaks, &sessions);
+  }
+
+//---------------------------------------------------------------------------------------
+// Returns the initial size for the named pool - its recorded peak plus some headroom or
+// default_size if the pool is not in the loaded profile
+
+uint32_t SkUEPoolProfile::get_init_size(const TCHAR * pool_name_p, uint32_t default_size)
+  {
+  const uint32 * peak_p = ms_peaks.Find(pool_name_p);
+  if (!peak_p)
+    {
+    return default_size;
+    }
+
+  return FMath::Max(*peak_p + *peak_p / c_headroom_divisor, c_min_init_size);
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes the peaks of all pools so far in this session
+
+bool SkUEPoolProfile::save_session(const FString & path)
+  {
+  TArray<SkUEMemoryTelemetry::PoolSample> pools;
+  SkUEMemoryTelemetry::sample_pools(&pools);
+
+  const TArray<FString> & pool_names = SkUEMemoryTelemetry::get_pool_names();
+  TMap<FString, uint32> peaks;
+  for (int32 pool_idx = 0; pool_idx < pools.Num(); ++pool_idx)
+    {
+    if (pools[pool_idx].m_count_max)
+      {
+      peaks.Add(pool_names[pool_idx], pools[pool_idx].m_count_max);
+      }
+    }
+
+  if (!peaks.Num())
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("No SkookumScript pool peaks to record - the libraries need to be built with AORPOOL_USAGE_COUNT."));
+    return false;
+    }
+
+  return write(path, peaks, 1);
+  }
+
+//---------------------------------------------------------------------------------------
+// Combines profiles by taking the largest peak of each pool
+
+bool SkUEPoolProfile::merge(const FString & out_path, const TArray<FString> & in_paths)
+  {
+  TMap<FString, uint32> merged;
+  int32 merged_sessions = 0;
+
+  for (const FString & in_path : in_paths)
+    {
+    TMap<FString, uint32> peaks;
+    int32 sessions = 0;
+    if (!read(in_path, &peaks, &sessions))
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Skipping unreadable SkookumScript pool profile '%s'."), *in_path);
+      continue;
+      }
+
+    for (const TPair<FString, uint32> & peak : peaks)
+      {
+      uint32 & merged_peak = merged.FindOrAdd(peak.Key);
+      merged_peak = FMath::Max(merged_peak, peak.Value);
+      }
+    merged_sessions += sessions;
+    }
+
+  return merged.Num() && write(out_path, merged, merged_sessions);
+  }
+
+//---------------------------------------------------------------------------------------
+
+bool SkUEPoolProfile::read(const FString & path, TMap<FString, uint32> * peaks_p, int32 * sessions_p)
+  {
+  FString profile;
+  if (!FFileHelper::LoadFileToString(profile, *path))
+    {
+    return false;
+    }
+
+  TSharedPtr<FJsonObject> root_p;
+  if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(profile), root_p) || !root_p.IsValid())
+    {
+    return false;
+    }
+
+  const TSharedPtr<FJsonObject> * pools_pp = nullptr;
+  if (!root_p->TryGetObjectField(TEXT("pools"), pools_pp))
+    {
+    return false;
+    }
+
+  for (const TPair<FString, TSharedPtr<FJsonValue>> & pool : (*pools_pp)->Values)
+    {
+    double peak;
+    if (pool.Value->TryGetNumber(peak) && peak >= 0.0)
+      {
+      peaks_p->Add(pool.Key, uint32(peak));
+      }
+    }
+
+  root_p->TryGetNumberField(TEXT("sessions"), *sessions_p);
+
+  return true;
+  }
+
+//---------------------------------------------------------------------------------------
+
+bool SkUEPoolProfile::write(const FString & path, const TMap<FString, uint32> & peaks, int32 sessions)
+  {
+  FString profile;
+  TSharedRef<TJsonWriter<>> writer_p = TJsonWriterFactory<>::Create(&profile);
+  writer_p->WriteObjectStart();
+  writer_p->WriteValue(TEXT("sessions"), sessions);
+  writer_p->WriteObjectStart(TEXT("pools"));
+  for (const TPair<FString, uint32> & peak : peaks)
+    {
+    writer_p->WriteValue(peak.Key, int64(peak.Value));
+    }
+  writer_p->WriteObjectEnd();
+  writer_p->WriteObjectEnd();
+  writer_p->Close();
+
+  return FFileHelper::SaveStringToFile(profile, *path);
+  }
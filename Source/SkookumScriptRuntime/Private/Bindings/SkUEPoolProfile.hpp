@@ -0,0 +1,78 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Initial object pool sizes from the peak usage of earlier sessions
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Pool profiles hold the peak number of objects used by each object reuse pool (named
+// as in SkUEMemoryTelemetry) over one or more sessions:
+//
+//   { "sessions": 3, "pools": { "AStringRef": 18211, "SkInstance": 2054, ... } }
+//
+// The profile at get_profile_path() is loaded before AgogCore is initialized and FAppInfo
+// then presizes the pools from it rather than from the hard-coded defaults - so neither
+// blocks are added mid-session nor are unused objects reserved. Pools not in the
+// profile keep their default size.
+//
+// When recording (the `PoolProfileRecord` setting or `-SkPoolProfileRecord`) each session
+// writes its peaks to get_session_path() on shutdown. `Sk.PoolProfile merge` combines
+// session profiles - e.g. from several playtest runs - into the profile that is loaded.
+// Peaks are only known if the libraries track pool usage (AORPOOL_USAGE_COUNT).
+class SkUEPoolProfile
+  {
+  public:
+
+  // Class Methods
+
+    static FString  get_profile_path();
+    static FString  get_session_path();
+
+    static bool     load(const FString & path);
+    static uint32_t get_init_size(const TCHAR * pool_name_p, uint32_t default_size);
+
+    static bool     save_session(const FString & path);
+    static bool     merge(const FString & out_path, const TArray<FString> & in_paths);
+
+  protected:
+
+  // Internal Class Methods
+
+    static bool read(const FString & path, TMap<FString, uint32> * peaks_p, int32 * sessions_p);
+    static bool write(const FString & path, const TMap<FString, uint32> & peaks, int32 sessions);
+
+  // Class Data Members
+
+    // Peaks of the loaded profile
+    static TMap<FString, uint32> ms_peaks;
+
+  };  // SkUEPoolProfile
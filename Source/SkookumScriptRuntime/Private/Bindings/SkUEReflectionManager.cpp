@@ -29,6 +29,10 @@
 #include "Engine/SkUEEntity.hpp"
 #include "Engine/SkUEActor.hpp"
 #include "SkUEUtils.hpp"
+#include "SkUECostAttribution.hpp"
+#include "SkUEDemandLoadManager.hpp"
+#include "SkUEMemberLookup.hpp"
+#include "SkUEScriptProfiler.hpp"
 #include "SkookumScriptInstanceProperty.h"
 #include "../../../SkookumScriptGenerator/Private/SkookumScriptGeneratorBase.h"
 
@@ -845,6 +849,9 @@ void SkUEReflectionManager::exec_sk_method(UObject* context_p, FFrame & stack, v
   SK_ASSERTX(reflected_call.m_type == ReflectedFunctionType_call, "ReflectedFunction has bad type!");
   SK_ASSERTX(reflected_call.m_sk_invokable_p->get_invoke_type() == SkInvokable_method, "Must be a method at this point.");
 
+  // Called from a Blueprint so the class group is in use
+  SkUEDemandLoadManager::get()->touch(*class_scope_p);
+
   SkMethodBase * method_p = static_cast<SkMethodBase *>(reflected_call.m_sk_invokable_p);
   if (method_p->get_scope() != class_scope_p)
     {
@@ -854,7 +861,7 @@ void SkUEReflectionManager::exec_sk_method(UObject* context_p, FFrame & stack, v
       if (!method_p || method_p->get_name() != reflected_call.get_name())
         {
         method_p = this_p
-          ? class_scope_p->find_instance_method_inherited(reflected_call.get_name())
+          ? SkUEMemberLookup::find_instance_method_inherited(class_scope_p, reflected_call.get_name())
           : class_scope_p->find_class_method_inherited(reflected_call.get_name());
         }
       // If still not found, that means the method placed in the graph is not in a parent class of class_scope_p
@@ -890,6 +897,9 @@ void SkUEReflectionManager::exec_sk_method(UObject* context_p, FFrame & stack, v
     else
   #endif
       {
+      SkUEScriptProfiler::Scope profile(method_p, &imethod, SkUEScriptProfiler::Origin_blueprint);
+      SkUECostAttribution::Scope cost(&imethod);
+
       // Call method
       SkInstance * result_instance_p = SkBrain::ms_nil_p;
       static_cast<SkMethod *>(method_p)->SkMethod::invoke(&imethod, nullptr, &result_instance_p); // We know it's a method so call directly
@@ -935,6 +945,7 @@ void SkUEReflectionManager::exec_sk_coroutine(UObject* context_p, FFrame & stack
   // Create invoked coroutine
   SkCoroutineBase * coro_p = static_cast<SkCoroutineBase *>(reflected_call.m_sk_invokable_p);
   SkClass * class_scope_p = this_p->get_class();
+  SkUEDemandLoadManager::get()->touch(*class_scope_p);   // Called from a Blueprint so the class group is in use
   if (coro_p->get_scope() != class_scope_p)
     {
     coro_p = static_cast<SkCoroutine *>(class_scope_p->get_invokable_from_vtable_i(coro_p->get_vtable_index()));
@@ -942,7 +953,7 @@ void SkUEReflectionManager::exec_sk_coroutine(UObject* context_p, FFrame & stack
       // If not found, might be due to recent live update and the vtable not being updated yet - try finding it by name
       if (coro_p == nullptr || coro_p->get_name() != reflected_call.m_sk_invokable_p->get_name())
         {
-        coro_p = class_scope_p->find_coroutine_inherited(reflected_call.m_sk_invokable_p->get_name());
+        coro_p = SkUEMemberLookup::find_coroutine_inherited(class_scope_p, reflected_call.m_sk_invokable_p->get_name());
         }
       // If still not found, that means the coroutine placed in the graph is not in a parent class of class_scope_p
       if (!coro_p)
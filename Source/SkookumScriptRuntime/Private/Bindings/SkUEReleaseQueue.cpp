@@ -0,0 +1,245 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Deferred, amortized destruction of SkookumScript instances
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEReleaseQueue.hpp"
+
+#include "Stats/Stats.h"
+
+#include <SkookumScript/Sk.hpp>
+#include <SkookumScript/SkBrain.hpp>
+#include <SkookumScript/SkClass.hpp>
+#include <SkookumScript/SkDataInstance.hpp>
+#include <SkookumScript/SkList.hpp>
+#include <SkookumScript/SkMethod.hpp>
+
+DECLARE_CYCLE_STAT(TEXT("SkookumScript Deferred Release"), STAT_SkookumScriptDeferredRelease, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("SkookumScript Release Queue Depth"), STAT_SkookumScriptReleaseQueueDepth, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("SkookumScript Releases Per Frame"), STAT_SkookumScriptReleasesPerFrame, STATGROUP_Game);
+
+//=======================================================================================
+// SkUEReleaseQueue Methods
+//=======================================================================================
+
+SkUEReleaseQueue * SkUEReleaseQueue::ms_singleton_p;
+
+//---------------------------------------------------------------------------------------
+
+SkUEReleaseQueue::SkUEReleaseQueue()
+  : m_is_enabled(false)
+  , m_max_per_frame(256u)
+  , m_queue_idx(0)
+  {
+  SK_ASSERTX(!ms_singleton_p, "There can be only one instance of this class.");
+  ms_singleton_p = this;
+
+  FMemory::Memzero(m_stats);
+  }
+
+//---------------------------------------------------------------------------------------
+
+SkUEReleaseQueue::~SkUEReleaseQueue()
+  {
+  SK_ASSERTX_NO_THROW(m_queue_idx >= m_queue.Num(), "Release queue destroyed while still holding on to instances - flush() should have been called at shutdown.");
+  SK_ASSERTX_NO_THROW(ms_singleton_p == this, "There can be only one instance of this class.");
+  ms_singleton_p = nullptr;
+  }
+
+//---------------------------------------------------------------------------------------
+// Releases a reference to an instance like dereference(), but if it is the last one the
+// instance is queued for destruction later instead of being destroyed right away.
+// Only defers while gameplay is running - see flush() - and only instances for which
+// is_deferrable() holds. Other instances are destroyed right away but their data members
+// may be deferred - see release_deferring_members().
+void SkUEReleaseQueue::release(SkInstance * instance_p)
+  {
+  if (!ms_singleton_p
+    || !ms_singleton_p->m_is_enabled
+    || instance_p->get_references() != 1u
+    || SkookumScript::get_initialization_level() < SkookumScript::InitializationLevel_gameplay)
+    {
+    instance_p->dereference();
+    }
+  else if (is_deferrable(instance_p))
+    {
+    ms_singleton_p->m_queue.Add(instance_p);
+    ++ms_singleton_p->m_stats.m_queued;
+    }
+  else
+    {
+    ms_singleton_p->release_deferring_members(instance_p);
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Destroys an instance holding its last reference like dereference() does - its script
+// destructor runs right away - but then hands the data members that would be destroyed
+// along with it over to the queue, as long as they are deferrable and own something
+// worth deferring (a list or data members of their own).
+void SkUEReleaseQueue::release_deferring_members(SkInstance * instance_p)
+  {
+  uint32_t data_count = instance_p->get_class()->get_total_data_count();
+  if (!data_count || !instance_p->is_ref_counted())
+    {
+    instance_p->dereference();
+    return;
+    }
+
+  // The destructor still sees all data members
+  instance_p->call_destructor();
+
+  // If the destructor stored a reference to the instance it lives on - and its destructor
+  // will run again once that reference is released
+  if (instance_p->get_references() != 1u)
+    {
+    instance_p->dereference();
+    return;
+    }
+
+  // Instances of classes with data members are always data instances
+  SkDataInstance * data_instance_p = static_cast<SkDataInstance *>(instance_p);
+  for (uint32_t data_idx = 0u; data_idx < data_count; ++data_idx)
+    {
+    SkInstance ** data_pp = data_instance_p->get_data_addr_by_idx(data_idx);
+    SkInstance * data_p = *data_pp;
+    if (data_p->get_references() == 1u
+      && is_deferrable(data_p)
+      && (data_p->get_class()->get_total_data_count() || data_p->get_class()->is_class(*SkList::get_class())))
+      {
+      *data_pp = SkBrain::ms_nil_p; // Reference is handed over to the queue
+      m_queue.Add(data_p);
+      ++m_stats.m_queued;
+      }
+    }
+
+  // Same as on_no_references() minus the destructor which already ran
+  instance_p->dereference_delay();
+  instance_p->delete_this();
+  }
+
+//---------------------------------------------------------------------------------------
+// Releases up to the per-frame budget of queued instances
+void SkUEReleaseQueue::update()
+  {
+  if (m_queue_idx >= m_queue.Num())
+    {
+    m_stats.m_last_frame_released = 0u;
+    return;
+    }
+
+  SCOPE_CYCLE_COUNTER(STAT_SkookumScriptDeferredRelease);
+
+  drain(m_max_per_frame);
+
+  SET_DWORD_STAT(STAT_SkookumScriptReleaseQueueDepth, m_stats.m_depth);
+  SET_DWORD_STAT(STAT_SkookumScriptReleasesPerFrame, m_stats.m_last_frame_released);
+  }
+
+//---------------------------------------------------------------------------------------
+// Releases all queued instances right away - call after gameplay has been deinitialized
+// and before the sim is so no references are held past that point.
+void SkUEReleaseQueue::flush()
+  {
+  drain(UINT32_MAX);
+  }
+
+//---------------------------------------------------------------------------------------
+// Releases queued instances until the queue is empty or `budget` releases have been made
+void SkUEReleaseQueue::drain(uint32_t budget)
+  {
+  uint32_t released = 0u;
+  m_stats.m_peak_depth = FMath::Max(m_stats.m_peak_depth, uint32_t(m_queue.Num() - m_queue_idx));
+
+  // Releasing can run script destructors which may queue more instances
+  while (released < budget && m_queue_idx < m_queue.Num())
+    {
+    SkInstance * instance_p = m_queue[m_queue_idx];
+
+    // Nothing else can get at a queued instance, so a list still holding the last
+    // reference to its items can be taken apart from the back a few at a time
+    if (instance_p->get_references() == 1u
+      && instance_p->get_class()->is_class(*SkList::get_class()))
+      {
+      APArray<SkInstance> & items = instance_p->as<SkList>().get_instances();
+      while (items.get_length() && released < budget)
+        {
+        SkInstance * item_p = items.pop_last(); // Reference is handed over to us
+        if (item_p->get_references() == 1u && is_deferrable(item_p))
+          {
+          m_queue.Add(item_p);
+          ++m_stats.m_queued;
+          }
+        else
+          {
+          item_p->dereference();
+          }
+        ++released;
+        }
+
+      if (items.get_length())
+        {
+        break; // Continue with this list next frame
+        }
+      }
+
+    m_queue_idx++;
+    instance_p->dereference();
+    ++released;
+    }
+
+  if (m_queue_idx >= m_queue.Num())
+    {
+    m_queue.Reset();
+    m_queue_idx = 0;
+    }
+
+  m_stats.m_released += released;
+  m_stats.m_last_frame_released = released;
+  m_stats.m_depth = m_queue.Num() - m_queue_idx;
+  }
+
+//---------------------------------------------------------------------------------------
+// Determines if destroying an instance can be put off without changing what its script
+// destructor sees - i.e. it is a plain script-owned instance without a script destructor
+
+bool SkUEReleaseQueue::is_deferrable(SkInstance * instance_p)
+  {
+  if (!instance_p->is_ref_counted())
+    {
+    return false;
+    }
+
+  // Engine objects are gone by the time a deferred release would happen
+  SkClass * class_p = instance_p->get_class();
+  if (class_p->is_entity_class() || class_p->is_component_class() || class_p->is_mind_class())
+    {
+    return false;
+    }
+
+  // Atomic destructors of built-in classes (e.g. List, String) do not depend on timing
+  SkMethodBase * destructor_p = class_p->get_instance_destructor_inherited();
+  return !destructor_p || destructor_p->get_invoke_type() != SkInvokable_method;
+  }
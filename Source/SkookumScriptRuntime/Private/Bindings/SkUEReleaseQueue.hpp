@@ -0,0 +1,107 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Deferred, amortized destruction of SkookumScript instances
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "Containers/Array.h"
+
+#include <SkookumScript/SkInstance.hpp>
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Optional queue of instances whose last reference the plugin has let go of, so destroying large
+// object graphs (e.g. on level transitions) can be spread out over several frames rather
+// than all happening at once.
+//
+// Only plain script-owned instances are deferred. Instances standing in for engine objects
+// (entities, components and minds) and instances of classes with a script destructor
+// (`!!`) are released right away so the destructor runs while its owner still exists.
+// Their data members are what makes them expensive to destroy though (e.g. a big List or
+// an actor with many members going away with its level), so once the destructor of such
+// an instance has run, the data members that would die along with it and are deferrable
+// themselves are detached and queued instead.
+//
+// update() releases a bounded number of instances per frame. Lists are taken apart a few
+// items at a time and items that would die along with the list are queued in turn.
+// Other instances are released in one go.
+class SkUEReleaseQueue
+  {
+  public:
+
+    struct Stats
+      {
+      uint32_t  m_queued;               // Total instances ever queued
+      uint32_t  m_released;             // Total references released from the queue (including list items)
+      uint32_t  m_depth;                // Instances currently waiting in the queue
+      uint32_t  m_peak_depth;           // Highest queue depth seen
+      uint32_t  m_last_frame_released;  // References released by the most recent update()
+      };
+
+    static SkUEReleaseQueue * get() { return ms_singleton_p; }
+
+  // Methods
+
+                SkUEReleaseQueue();
+               ~SkUEReleaseQueue();
+
+    static void release(SkInstance * instance_p);
+
+    void        update();
+    void        flush();
+
+    bool        is_enabled() const                            { return m_is_enabled; }
+    void        set_enabled(bool is_enabled)                  { m_is_enabled = is_enabled; if (!is_enabled) { flush(); } }
+    uint32_t    get_max_per_frame() const                     { return m_max_per_frame; }
+    void        set_max_per_frame(uint32_t max_per_frame)     { m_max_per_frame = max_per_frame ? max_per_frame : 1u; }
+    const Stats & get_stats() const                           { return m_stats; }
+
+  protected:
+
+  // Internal Methods
+
+    void        drain(uint32_t budget);
+    void        release_deferring_members(SkInstance * instance_p);
+
+    static bool is_deferrable(SkInstance * instance_p);
+
+  // Data Members
+
+    bool                  m_is_enabled;
+    uint32_t              m_max_per_frame;  // Budget of releases per update()
+
+    // Queued instances - each holds the last reference to its instance
+    TArray<SkInstance *>  m_queue;
+    int32                 m_queue_idx;      // Next instance to release
+
+    Stats                 m_stats;
+
+    static SkUEReleaseQueue * ms_singleton_p;
+
+  };  // SkUEReleaseQueue
@@ -30,6 +30,12 @@
 #ifdef SKOOKUM_REMOTE_UNREAL
 
 #include "SkUERuntime.hpp"
+#include "Bindings/SkUEMemberLookup.hpp"
+#include "Bindings/SkUEScriptProfiler.hpp"
+#include "Bindings/SkUEHeatMap.hpp"
+#include "Bindings/SkUEAllocationTracer.hpp"
+#include "Bindings/SkUEMemoryTelemetry.hpp"
+#include "Bindings/SkUEScriptSampler.hpp"
 #include "Bindings/SkUEReflectionManager.hpp"
 #include "../SkookumScriptRuntimeGenerator.h"
 #include "Bindings/SkUEUtils.hpp"
@@ -150,7 +156,9 @@ SkUERemote::SkUERemote(FSkookumScriptRuntimeGenerator * runtime_generator_p) :
   m_editor_interface_p(nullptr),
   m_runtime_generator_p(runtime_generator_p),
   m_last_connected_to_ide(false),
-  m_class_data_needs_to_be_regenerated(false)
+  m_class_data_needs_to_be_regenerated(false),
+  m_memory_stream_interval(0u),
+  m_memory_stream_frames(0u)
   {
   }
 
@@ -472,6 +480,75 @@ SkRemoteBase::eSendResponse SkUERemote::on_cmd_send(const ADatum & datum)
     return SendResponse_OK;
   }
 
+//---------------------------------------------------------------------------------------
+// Handles commands from the remote IDE that are specific to this runtime and passes the
+// rest on to the base class
+// 
+// #Modifiers: virtual
+bool SkUERemote::on_cmd_recv(eCommand cmd, const uint8_t * data_p, uint32_t data_length)
+  {
+  switch (cmd)
+    {
+    case Command_memory:
+      {
+      // Optional number of frames between streamed replies - 0 or none for a single reply
+      uint32_t interval = 0u;
+      if (data_length >= sizeof(uint32_t))
+        {
+        A_BYTE_STREAM_IN32(&interval, &data_p);
+        }
+
+      m_memory_stream_interval = interval;
+      m_memory_stream_frames = 0u;
+      if (interval)
+        {
+        SkUEMemoryTelemetry::enable();
+        }
+      cmd_memory_reply();
+      return true;
+      }
+
+    default:
+      return SkRemoteRuntimeBase::on_cmd_recv(cmd, data_p, data_length);
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Sends the most recent memory telemetry frame to the remote IDE
+// 
+// See: SkUEMemoryTelemetry::as_binary()
+void SkUERemote::cmd_memory_reply()
+  {
+  // Make sure there is something to send even if telemetry was not running
+  if (!SkUEMemoryTelemetry::get_frame_count())
+    {
+    bool was_enabled = SkUEMemoryTelemetry::is_enabled();
+    SkUEMemoryTelemetry::enable();
+    SkUEMemoryTelemetry::sample();
+    SkUEMemoryTelemetry::enable(was_enabled);
+    }
+
+  uint32_t cmd = Command_memory_reply;
+  ADatum   datum(4u + SkUEMemoryTelemetry::as_binary_length());
+  uint8_t * data_p = datum.get_data_writable();
+
+  A_BYTE_STREAM_OUT32(&data_p, &cmd);
+  SkUEMemoryTelemetry::as_binary(reinterpret_cast<void **>(&data_p));
+
+  on_cmd_send(datum);
+  }
+
+//---------------------------------------------------------------------------------------
+// Called once per tick - sends memory telemetry if the IDE asked for it to be streamed
+void SkUERemote::update_memory_stream()
+  {
+  if (m_memory_stream_interval && is_authenticated() && (++m_memory_stream_frames >= m_memory_stream_interval))
+    {
+    m_memory_stream_frames = 0u;
+    cmd_memory_reply();
+    }
+  }
+
 //---------------------------------------------------------------------------------------
 // Make this editable and tell IDE about it
 void SkUERemote::on_cmd_make_editable()
@@ -508,6 +585,13 @@ void SkUERemote::on_class_updated(SkClass * class_p)
   // Call superclass behavior
   SkRemoteBase::on_class_updated(class_p);
 
+  // Routines of this class and its subclasses might have changed
+  SkUEMemberLookup::invalidate();
+  SkUEScriptSampler::forget_invokables(); // First - draining it feeds the others
+  SkUEScriptProfiler::forget_invokables();
+  SkUEHeatMap::forget_invokables();
+  SkUEAllocationTracer::forget_invokables();
+
   #if WITH_EDITOR
     AMethodArg2<ISkookumScriptRuntimeEditorInterface, UFunction*, bool> editor_on_function_updated_f(m_editor_interface_p, &ISkookumScriptRuntimeEditorInterface::on_function_updated);
     AMethodArg<ISkookumScriptRuntimeEditorInterface, UClass*>           editor_on_function_removed_from_class_f(m_editor_interface_p, &ISkookumScriptRuntimeEditorInterface::on_function_removed_from_class);
@@ -527,6 +611,12 @@ void SkUERemote::on_connect_change(eConnectState old_state)
   // Call base class
   SkRemoteRuntimeBase::on_connect_change(old_state);
 
+  // A new connection has to ask for memory telemetry again
+  if (m_connect_state != ConnectState_authenticated)
+    {
+    m_memory_stream_interval = 0u;
+    }
+
   // When in read-only (REPL) mode, regenerate all script files upon each connection to IDE
   #if WITH_EDITORONLY_DATA
     if (m_runtime_generator_p
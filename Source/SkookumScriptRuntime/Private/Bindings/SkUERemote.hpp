@@ -119,6 +119,9 @@ class SkUERemote : public SkRemoteRuntimeBase
 
     // Commands
 
+    void                      cmd_memory_reply();
+    void                      update_memory_stream();
+
   protected:
 
     AString                   get_socket_str(const FInternetAddr & addr);
@@ -127,6 +130,7 @@ class SkUERemote : public SkRemoteRuntimeBase
   // Events
 
     virtual eSendResponse     on_cmd_send(const ADatum & datum) override;
+    virtual bool              on_cmd_recv(eCommand cmd, const uint8_t * data_p, uint32_t data_length) override;
     virtual void              on_cmd_make_editable() override;
     virtual void              on_cmd_freshen_compiled_reply(eCompiledState state) override;
     virtual void              on_class_updated(SkClass * class_p) override;
@@ -154,6 +158,12 @@ class SkUERemote : public SkRemoteRuntimeBase
     // If all class data needs to be regenerated
     bool  m_class_data_needs_to_be_regenerated;
 
+    // Frames between memory telemetry replies streamed to the IDE - 0 when not streaming
+    uint32_t      m_memory_stream_interval;
+
+    // Frames since the last streamed memory telemetry reply
+    uint32_t      m_memory_stream_frames;
+
   };  // SkUERemote
 
 #endif  // SKOOKUM_REMOTE_UNREAL
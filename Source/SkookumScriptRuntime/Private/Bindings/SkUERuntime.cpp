@@ -26,12 +26,25 @@
 //=======================================================================================
 
 #include "SkUERuntime.hpp"
+#include "ISkookumScriptRuntime.h"
 #include "SkUERemote.hpp"
 #include "SkUEBindings.hpp"
 #include "SkUEClassBinding.hpp"
 #include "SkUEUtils.hpp"
-
+#include "SkUEBinaryCompression.hpp"
+#include "SkUEMemberLookup.hpp"
+#include "SkUEScriptProfiler.hpp"
+#include "SkUEHeatMap.hpp"
+#include "SkUEAllocationTracer.hpp"
+#include "SkUEScriptSampler.hpp"
+#include "SkUEStartupProfiler.hpp"
+
+#include "Async/MappedFileHandle.h"
 #include "GenericPlatform/GenericPlatformProcess.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/ScopeLock.h"
+#include "Async/Async.h"
 #include "UObject/UObjectHash.h"
 #include "UObject/UObjectIterator.h"
 #include "Engine/Blueprint.h"
@@ -51,6 +64,24 @@
 namespace
 {
 
+  //---------------------------------------------------------------------------------------
+  // Memory mapped compiled binary file
+  struct SkMappedBinaryUE
+    {
+    IMappedFileHandle * m_handle_p;
+    IMappedFileRegion * m_region_p;
+    };
+
+  // Mapped binaries stay mapped until the runtime releases their handle - any still mapped
+  // at shutdown are released then. Pages of a mapping that are not touched are never read,
+  // and touched ones are clean and can be dropped by the OS.
+  static TArray<SkMappedBinaryUE> s_mapped_binaries;
+  static FCriticalSection         s_mapped_binaries_cs; // Binaries may be created by prefetch workers
+
+  // Not in editor builds since the SkookumIDE rewrites the binaries while the editor is
+  // running, which mapped files would prevent on some platforms
+  static const bool s_use_mapped_binaries = !WITH_EDITORONLY_DATA;
+
   //---------------------------------------------------------------------------------------
   // Custom Unreal Binary Handle Structure
   struct SkBinaryHandleUE : public SkBinaryHandle
@@ -58,12 +89,80 @@ namespace
     // Public Methods
 
       //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-      SkBinaryHandleUE(void * binary_p, uint32_t size) : SkBinaryHandle(binary_p, size)
+      SkBinaryHandleUE(void * binary_p, uint32_t size, bool is_mapped = false) : SkBinaryHandle(binary_p, size), m_is_mapped(is_mapped)
         {
         }
 
+      //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+      virtual ~SkBinaryHandleUE() override
+        {
+        if (m_is_mapped)
+          {
+          release_mapped(m_binary_p);
+          }
+        else
+          {
+          FMemory::Free(m_binary_p);
+          }
+        }
+
       //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
       static SkBinaryHandleUE * create(const TCHAR * path_p)
+        {
+        SkBinaryHandleUE * handle_p = s_use_mapped_binaries ? create_mapped(path_p) : nullptr;
+        if (handle_p && SkUEBinaryCompression::is_compressed(handle_p->m_binary_p, handle_p->m_size))
+          {
+          // Compressed binaries are decompressed to the heap so the mapping is not needed
+          uint32_t size = 0u;
+          uint8_t * binary_p = SkUEBinaryCompression::decompress(handle_p->m_binary_p, handle_p->m_size, &size);
+          delete handle_p;
+
+          return binary_p ? new SkBinaryHandleUE(binary_p, size) : nullptr;
+          }
+
+        return handle_p ? handle_p : create_read(path_p);
+        }
+
+      //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+      // Seconds it takes to load (and decompress) a binary the way the runtime loads it
+      static double time_load(const TCHAR * path_p)
+        {
+        double start_time = FPlatformTime::Seconds();
+        SkBinaryHandleUE * handle_p = create(path_p);
+        double seconds = FPlatformTime::Seconds() - start_time;
+        delete handle_p;
+        return seconds;
+        }
+
+      //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+      // Map file into memory - returns nullptr if the platform or the file's location
+      // (e.g. inside a pak file) does not support memory mapping
+      static SkBinaryHandleUE * create_mapped(const TCHAR * path_p)
+        {
+        IMappedFileHandle * mapped_handle_p = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(path_p);
+        if (!mapped_handle_p)
+          {
+          return nullptr;
+          }
+
+        int64 size = mapped_handle_p->GetFileSize();
+        IMappedFileRegion * region_p = size > 0 ? mapped_handle_p->MapRegion(0, size) : nullptr;
+        if (!region_p)
+          {
+          delete mapped_handle_p;
+          return nullptr;
+          }
+
+        FScopeLock lock(&s_mapped_binaries_cs);
+        s_mapped_binaries.Add({ mapped_handle_p, region_p });
+
+        // The runtime only ever reads from the binary
+        return new SkBinaryHandleUE(const_cast<uint8 *>(region_p->GetMappedPtr()), (uint32_t)size, true);
+        }
+
+      //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+      // Read whole file into heap memory
+      static SkBinaryHandleUE * create_read(const TCHAR * path_p)
         {
         FArchive * reader_p = IFileManager::Get().CreateFileReader(path_p);
         if (!reader_p)
@@ -80,6 +179,22 @@ namespace
           return nullptr;
           }
 
+        // Block-compressed binaries are decompressed while being read
+        SkUEBinaryCompression::Header header;
+        if (size >= sizeof(header))
+          {
+          reader_p->Serialize(&header, sizeof(header));
+          if (SkUEBinaryCompression::is_compressed(&header, sizeof(header)))
+            {
+            uint8 * binary_p = SkUEBinaryCompression::read_decompress(reader_p, header);
+            reader_p->Close();
+            delete reader_p;
+
+            return binary_p ? new SkBinaryHandleUE(binary_p, header.m_uncompressed_size) : nullptr;
+            }
+          reader_p->Seek(0);
+          }
+
         uint8 * binary_p = (uint8*)FMemory::Malloc(size);
         if (!binary_p)
           {
@@ -95,15 +210,59 @@ namespace
 
         if (!success)
           {
-          delete binary_p;
+          FMemory::Free(binary_p);
           return nullptr;
           }
 
         return new SkBinaryHandleUE(binary_p, (uint32_t)size);
         }
+
+      //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+      static void release_mapped(const void * binary_p)
+        {
+        FScopeLock lock(&s_mapped_binaries_cs);
+        int32 mapped_idx = s_mapped_binaries.IndexOfByPredicate([binary_p](const SkMappedBinaryUE & mapped) { return mapped.m_region_p->GetMappedPtr() == binary_p; });
+        if (mapped_idx != INDEX_NONE)
+          {
+          delete s_mapped_binaries[mapped_idx].m_region_p;
+          delete s_mapped_binaries[mapped_idx].m_handle_p;
+          s_mapped_binaries.RemoveAtSwap(mapped_idx);
+          }
+        }
+
+      //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+      // Releases mappings whose handles were never released
+
+      //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+      static void release_all_mapped()
+        {
+        FScopeLock lock(&s_mapped_binaries_cs);
+        for (SkMappedBinaryUE & mapped : s_mapped_binaries)
+          {
+          delete mapped.m_region_p;
+          delete mapped.m_handle_p;
+          }
+        s_mapped_binaries.Empty();
+        }
+
+    // Public Data
+
+      // Set if m_binary_p is a mapping from s_mapped_binaries, otherwise it is heap memory
+      bool m_is_mapped;
     };
 
 
+  #if WITH_EDITOR
+
+    //---------------------------------------------------------------------------------------
+    // Converts the compiled binaries to block-compressed containers e.g. before packaging
+    static FAutoConsoleCommand s_compress_binaries_cmd(
+      TEXT("Sk.CompressBinaries"),
+      TEXT("Converts the compiled SkookumScript binaries to block-compressed binaries. The SkookumIDE writes uncompressed binaries again on its next compile."),
+      FConsoleCommandDelegate::CreateLambda([]() { SkUERuntime::get_singleton()->compress_compiled_binaries(); }));
+
+  #endif
+
 } // End unnamed namespace
 
 //=======================================================================================
@@ -117,6 +276,7 @@ SkUERuntime::SkUERuntime()
   , m_is_compiled_scripts_loaded(false)
   , m_is_compiled_scripts_bound(false)
   , m_have_game_module(false)
+  , m_is_hierarchy_mapped(false)
   , m_compiled_file_b(false)
   , m_listener_manager(256, 256)
   , m_project_generated_bindings_p(nullptr)
@@ -133,6 +293,8 @@ void SkUERuntime::startup()
   {
   SK_ASSERTX(!m_is_initialized, "Tried to initialize SkUERuntime twice in a row.");
 
+  SkUEStartupProfiler::Scope phase(TEXT("SkUERuntime::startup"));
+
   A_DPRINT("\nSkookumScript starting up.\n");
 
   // Let scripting system know that the game engine is present and is being hooked-in
@@ -169,6 +331,10 @@ void SkUERuntime::shutdown()
     SkRemoteBase::ms_default_p->set_mode(SkLocale_embedded);
   #endif
 
+  //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // The sampler thread reads the call stack so it must not outlive it
+  SkUEScriptSampler::stop();
+
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   // Clears out Blueprint interface mappings
   SkUEReflectionManager::get()->clear(nullptr);
@@ -180,12 +346,26 @@ void SkUERuntime::shutdown()
     // In Commandlet mode, sim might not be running
     if (SkookumScript::get_initialization_level() >= SkookumScript::InitializationLevel_sim)
       {
+      // Free remaining garbage cycles and queued instances and stop deferring so no
+      // references are held past this point
+      m_cycle_collector.set_enabled(false);
+      m_release_queue.set_enabled(false);
       SkookumScript::deinitialize_sim();
       SkookumScript::deinitialize_program();
       }
     SkookumScript::deinitialize();
     }
 
+  // Program is gone so binaries and lookups are no longer needed
+  discard_prefetched_class_groups();
+  m_demand_load_manager.reset();
+  SkUEMemberLookup::invalidate();
+  SkUEScriptSampler::forget_invokables(); // First - draining it feeds the others
+  SkUEScriptProfiler::forget_invokables();
+  SkUEHeatMap::forget_invokables();
+  SkUEAllocationTracer::forget_invokables();
+  SkBinaryHandleUE::release_all_mapped();
+
   // Keep track just in case
   m_is_compiled_scripts_loaded = false;
   m_is_compiled_scripts_bound = false;
@@ -207,6 +387,7 @@ void SkUERuntime::shutdown()
 
 void SkUERuntime::ensure_static_ue_types_registered()
   {
+  SkUEStartupProfiler::Scope phase(TEXT("ensure_static_ue_types_registered"));
   SkUEBindings::ensure_static_ue_types_registered(m_project_generated_bindings_p);
   }
 
@@ -263,6 +444,8 @@ void SkUERuntime::set_project_generated_bindings(SkUEBindingsInterface * project
 // Gather list of all reflected classes, routines and properties, but do not reflect them to UE4 yet
 void SkUERuntime::sync_all_reflected_from_sk()
   {
+  SkUEStartupProfiler::Scope phase(TEXT("sync_all_reflected_from_sk"));
+
   #if WITH_EDITOR
     AMethodArg<ISkookumScriptRuntimeEditorInterface, UClass*> editor_on_function_removed_from_class_f(m_editor_interface_p, &ISkookumScriptRuntimeEditorInterface::on_function_removed_from_class);
     tSkUEOnFunctionRemovedFromClassFunc * on_function_removed_from_class_f = &editor_on_function_removed_from_class_f;
@@ -276,6 +459,8 @@ void SkUERuntime::sync_all_reflected_from_sk()
 // Bind all routines in the binding list to UE4 by generating UFunction objects
 void SkUERuntime::sync_all_reflected_to_ue(bool is_final)
   {
+  SkUEStartupProfiler::Scope phase(TEXT("sync_all_reflected_to_ue"));
+
   #if WITH_EDITOR
     AMethodArg2<ISkookumScriptRuntimeEditorInterface, UFunction*, bool> editor_on_function_updated_f(m_editor_interface_p, &ISkookumScriptRuntimeEditorInterface::on_function_updated);
     tSkUEOnFunctionUpdatedFunc * on_function_updated_f = &editor_on_function_updated_f;
@@ -355,14 +540,31 @@ bool SkUERuntime::load_compiled_scripts()
   {
   SK_ASSERTX(m_is_initialized, "SkookumScruipt must be initialized to be able to load compiled scripts.");
 
+  SkUEStartupProfiler::Scope phase(TEXT("load_compiled_scripts"));
+
   A_DPRINT("\nSkookumScript loading previously parsed compiled binary...\n");
 
+  // Binaries are about to be replaced so anything prefetched or looked up from the old ones is stale
+  discard_prefetched_class_groups();
+  m_demand_load_manager.reset();
+  SkUEMemberLookup::invalidate();
+  SkUEScriptSampler::forget_invokables(); // First - draining it feeds the others
+  SkUEScriptProfiler::forget_invokables();
+  SkUEHeatMap::forget_invokables();
+  SkUEAllocationTracer::forget_invokables();
+
+  double start_time = FPlatformTime::Seconds();
+  m_is_hierarchy_mapped = false;
+
+  {
+  SkUEStartupProfiler::Scope hierarchy_phase(TEXT("load_compiled_hierarchy"));
   if (load_compiled_hierarchy() != SkLoadStatus_ok)
     {
     return false;
     }
+  }
 
-  A_DPRINT("  ...done!\n\n");
+  A_DPRINT("  ...done in %.1fms%s!\n\n", (FPlatformTime::Seconds() - start_time) * 1000.0, m_is_hierarchy_mapped ? " (memory mapped)" : "");
 
   // After fresh loading of binaries, there are no bindings
   m_is_compiled_scripts_loaded = true;
@@ -370,7 +572,10 @@ bool SkUERuntime::load_compiled_scripts()
 
   // After loading, hook up a few things right away
   ensure_static_ue_types_registered();
+  {
+  SkUEStartupProfiler::Scope bindings_phase(TEXT("begin_register_bindings"));
   SkUEBindings::begin_register_bindings();
+  }
 
   // Immediately expose reflected types here to make them available for Blueprint compilation
   sync_all_reflected_from_sk();
@@ -406,13 +611,18 @@ void SkUERuntime::bind_compiled_scripts(
   SK_ASSERTX(m_is_initialized, "SkookumScript must be initialized to be able to bind compiled scripts.");
   SK_ASSERTX(m_is_compiled_scripts_loaded, "Compiled binaries must be loaded to be able to bind.");
 
+  SkUEStartupProfiler::Scope phase(TEXT("bind_compiled_scripts"));
+
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   // Bind atomics
   A_DPRINT("SkookumScript binding with C++ routines...\n");
 
   // Registers/connects Generic SkookumScript atomic classes, stimuli, coroutines, etc.
   // with the compiled binary that was just loaded.
+  {
+  SkUEStartupProfiler::Scope program_phase(TEXT("SkookumScript::initialize_program"));
   SkookumScript::initialize_program();
+  }
 
   // Did we just hot reload?
   if (is_hot_reload)
@@ -463,7 +673,10 @@ void SkUERuntime::bind_compiled_scripts(
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   // Enable SkookumScript evaluation
   A_DPRINT("SkookumScript initializing session...\n");
+  {
+  SkUEStartupProfiler::Scope sim_phase(TEXT("SkookumScript::initialize_sim"));
   SkookumScript::initialize_sim();
+  }
   A_DPRINT("  ...done!\n\n");
   }
 
@@ -519,27 +732,162 @@ void SkUERuntime::on_binary_hierarchy_path_changed()
 // #Author(s):  Conan Reis
 SkBinaryHandle * SkUERuntime::get_binary_hierarchy()
   {
+  SkUEStartupProfiler::Scope phase(TEXT("get_binary_hierarchy"));
+
   FString compiled_file = FPaths::ConvertRelativePathToFull(get_compiled_path() / TEXT("classes.sk-bin"));
 
   A_DPRINT("  Loading compiled binary file '%ls'...\n", *compiled_file);
 
-  return SkBinaryHandleUE::create(*compiled_file);
+  // Recorded here since the mapping is usually released again by the time loading is done
+  SkBinaryHandleUE * handle_p = SkBinaryHandleUE::create(*compiled_file);
+  m_is_hierarchy_mapped = handle_p && handle_p->m_is_mapped;
+
+  return handle_p;
   }
 
 //---------------------------------------------------------------------------------------
 // Gets memory representing binary for group of classes with specified class as root.
 // Used as a mechanism to "demand load" scripts.
 // 
-// #See Also:   load_compiled_scripts()
+// #See Also:   load_compiled_scripts(), prefetch_class_group()
 // #Modifiers:  virtual - overridden from SkRuntimeBase
 // #Author(s):  Conan Reis
 SkBinaryHandle * SkUERuntime::get_binary_class_group(const SkClass & cls)
+  {
+  // If prefetched, use what the worker got - waits if it is still in flight which is
+  // never slower than starting the read now
+  TFuture<SkBinaryHandle *> * prefetched_p = m_prefetched_class_groups.Find(cls.get_name_id());
+  if (prefetched_p)
+    {
+    SkBinaryHandle * handle_p = prefetched_p->Get();
+    m_prefetched_class_groups.Remove(cls.get_name_id());
+    if (handle_p)
+      {
+      return handle_p;
+      }
+    }
+
+  return SkBinaryHandleUE::create(*get_binary_class_group_path(cls));
+  }
+
+//---------------------------------------------------------------------------------------
+// Loads group of classes with specified class as root and lets the demand load manager
+// know so it can keep the loaded groups within budget.
+// 
+// #See Also:   get_binary_class_group(), SkUEDemandLoadManager
+// #Modifiers:  virtual - overridden from SkRuntimeBase
+void SkUERuntime::load_compiled_class_group(SkClass * class_p)
+  {
+  SkRuntimeBase::load_compiled_class_group(class_p);
+
+  SkClass * root_p = class_p->get_demand_loaded_root();
+  if (root_p && root_p->is_loaded())
+    {
+    m_demand_load_manager.on_group_loaded(root_p);
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Path of the binary for the group of classes with specified class as root
+
+FString SkUERuntime::get_binary_class_group_path(const SkClass & cls) const
   {
   FString compiled_file = get_compiled_path();
   
   // $Revisit - CReis Should use fast custom uint32_t to hex string function.
   compiled_file += a_cstr_format("/Class[%x].sk-bin", cls.get_name_id());
-  return SkBinaryHandleUE::create(*compiled_file);
+  return compiled_file;
+  }
+
+//---------------------------------------------------------------------------------------
+// Starts reading the binary of the demand-loaded class group containing `cls` on a worker
+// thread so that a later demand load of the group does not have to wait for the file.
+// Does nothing if the class is not demand loaded or its group is already loaded or
+// being prefetched.
+//
+// #See Also:   get_binary_class_group()
+void SkUERuntime::prefetch_class_group(const SkClass & cls)
+  {
+  SkClass * root_p = cls.get_demand_loaded_root();
+  if (!root_p || m_prefetched_class_groups.Contains(root_p->get_name_id()))
+    {
+    return;
+    }
+
+  if (root_p->is_loaded())
+    {
+    // About to be used so keep it around
+    m_demand_load_manager.touch(*root_p);
+    return;
+    }
+
+  FString compiled_file = get_binary_class_group_path(*root_p);
+  m_prefetched_class_groups.Add(
+    root_p->get_name_id(), 
+    Async<SkBinaryHandle *>(EAsyncExecution::ThreadPool, [compiled_file]() -> SkBinaryHandle * { return SkBinaryHandleUE::create(*compiled_file); }));
+  }
+
+//---------------------------------------------------------------------------------------
+// Waits for and releases all class group binaries that were prefetched but not used
+
+void SkUERuntime::discard_prefetched_class_groups()
+  {
+  for (auto & prefetched : m_prefetched_class_groups)
+    {
+    SkBinaryHandle * handle_p = prefetched.Value.Get();
+    if (handle_p)
+      {
+      release_binary(handle_p);
+      }
+    }
+  m_prefetched_class_groups.Empty();
+  }
+
+//---------------------------------------------------------------------------------------
+// Converts all compiled binaries to block-compressed containers in place and logs their
+// sizes and load times before and after. Loading detects compressed binaries, so no
+// other setting is needed. Load times are taken with the file in the OS cache, so they
+// compare decompression against reading the uncompressed bytes rather than disk speed.
+// 
+// #See Also:   SkUEBinaryCompression
+void SkUERuntime::compress_compiled_binaries()
+  {
+  FString compiled_path = FPaths::ConvertRelativePathToFull(get_compiled_path());
+
+  TArray<FString> file_names;
+  IFileManager::Get().FindFiles(file_names, *compiled_path, TEXT("sk-bin"));
+  TArray<FString> sym_file_names;
+  IFileManager::Get().FindFiles(sym_file_names, *compiled_path, TEXT("sk-sym"));
+  file_names.Append(sym_file_names);
+
+  A_DPRINT("\nSkookumScript compressing compiled binaries in '%ls'...\n", *compiled_path);
+
+  uint64_t uncompressed_total = 0u;
+  uint64_t compressed_total = 0u;
+  double   uncompressed_load_total = 0.0;
+  double   compressed_load_total = 0.0;
+  for (const FString & file_name : file_names)
+    {
+    FString file_path = compiled_path / file_name;
+    double uncompressed_load_seconds = SkBinaryHandleUE::time_load(*file_path);
+    SkUEBinaryCompression::Stats stats;
+    if (!SkUEBinaryCompression::compress_file(*file_path, *file_path, SkUEBinaryCompression::Block_size_def, &stats))
+      {
+      A_DPRINT("  %ls - failed!\n", *file_name);
+      continue;
+      }
+    double compressed_load_seconds = SkBinaryHandleUE::time_load(*file_path);
+
+    A_DPRINT("  %ls - %u -> %u bytes (%.1f%%) in %.1fms, loads in %.2fms -> %.2fms\n", *file_name, stats.m_uncompressed_size, stats.m_compressed_size, stats.m_uncompressed_size ? 100.0 * stats.m_compressed_size / stats.m_uncompressed_size : 100.0, stats.m_seconds * 1000.0, uncompressed_load_seconds * 1000.0, compressed_load_seconds * 1000.0);
+    uncompressed_total += stats.m_uncompressed_size;
+    compressed_total += stats.m_compressed_size;
+    uncompressed_load_total += uncompressed_load_seconds;
+    compressed_load_total += compressed_load_seconds;
+    }
+
+  A_DPRINT("  ...done!\n\n");
+  UE_LOG(LogSkookum, Display, TEXT("Compressed %d SkookumScript binaries from %llu to %llu bytes - loading them takes %.2f ms compressed vs. %.2f ms uncompressed."),
+    file_names.Num(), uncompressed_total, compressed_total, compressed_load_total * 1000.0, uncompressed_load_total * 1000.0);
   }
 
 
@@ -553,6 +901,8 @@ SkBinaryHandle * SkUERuntime::get_binary_class_group(const SkClass & cls)
 // #Author(s):  Conan Reis
 SkBinaryHandle * SkUERuntime::get_binary_symbol_table()
   {
+  SkUEStartupProfiler::Scope phase(TEXT("get_binary_symbol_table"));
+
   FString sym_file = FPaths::ConvertRelativePathToFull(get_compiled_path() / TEXT("classes.sk-sym"));
 
   A_DPRINT("  Loading compiled binary symbol file '%ls'...\n", *sym_file);
@@ -572,6 +922,8 @@ SkBinaryHandle * SkUERuntime::get_binary_symbol_table()
 
 
 //---------------------------------------------------------------------------------------
+// Unmaps or frees the binary along with its handle - the runtime does not refer to a
+// binary once it has been loaded
 // #Author(s):  Conan Reis
 void SkUERuntime::release_binary(SkBinaryHandle * handle_p)
   {
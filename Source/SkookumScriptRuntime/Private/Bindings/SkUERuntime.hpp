@@ -28,8 +28,12 @@
 
 #include "../SkookumScriptListenerManager.hpp"
 #include "SkUEReflectionManager.hpp"
+#include "SkUECycleCollector.hpp"
+#include "SkUEReleaseQueue.hpp"
+#include "SkUEDemandLoadManager.hpp"
 
 #include "HAL/Platform.h"  // Set up base types, etc for the platform
+#include "Async/Future.h"
 
 #include <SkookumScript/SkRuntimeBase.hpp>
 #include <SkookumScript/SkParser.hpp>
@@ -72,9 +76,15 @@ class SkUERuntime :
       bool load_compiled_scripts();
       void bind_compiled_scripts(bool is_hot_reload = false, bool ensure_atomics = true, SkClass ** ignore_classes_pp = nullptr, uint32_t ignore_count = 0u);
 
+      void compress_compiled_binaries();
+
       void sync_all_reflected_from_sk();
       void sync_all_reflected_to_ue(bool is_final);
 
+    // Demand Loading
+
+      void prefetch_class_group(const SkClass & cls);
+
     // Overridden from SkRuntimeBase
 
       // Binary Serialization / Loading Overrides
@@ -83,6 +93,7 @@ class SkUERuntime :
         virtual void             on_binary_hierarchy_path_changed() override;
         virtual SkBinaryHandle * get_binary_hierarchy() override;
         virtual SkBinaryHandle * get_binary_class_group(const SkClass & cls) override;
+        virtual void             load_compiled_class_group(SkClass * class_p) override;
         virtual void             release_binary(SkBinaryHandle * handle_p) override;
 
         #if defined(A_SYMBOL_STR_DB_AGOG)  
@@ -104,6 +115,9 @@ class SkUERuntime :
         SkookumScriptListenerManager *         get_listener_manager()                 { return &m_listener_manager; }
         SkUEReflectionManager *                get_reflection_manager()               { return &m_reflection_manager; }
         const SkUEReflectionManager *          get_reflection_manager() const         { return &m_reflection_manager; }
+        SkUECycleCollector *                   get_cycle_collector()                  { return &m_cycle_collector; }
+        SkUEReleaseQueue *                     get_release_queue()                    { return &m_release_queue; }
+        SkUEDemandLoadManager *                get_demand_load_manager()              { return &m_demand_load_manager; }
         ISkookumScriptRuntimeEditorInterface * get_editor_interface() const           { return m_editor_interface_p; }
         SkUEBindingsInterface *                get_project_generated_bindings() const { return m_project_generated_bindings_p; }
 
@@ -112,18 +126,30 @@ class SkUERuntime :
 
   protected:
 
+    // Internal Methods
+
+      FString get_binary_class_group_path(const SkClass & cls) const;
+      void    discard_prefetched_class_groups();
+
     // Data Members
 
       bool                m_is_initialized;
       bool                m_is_compiled_scripts_loaded; // If compiled binaries have ever been loaded
       bool                m_is_compiled_scripts_bound;  // If on_bind_routines() has been called at least once
       bool                m_have_game_module; // If set_project_generated_bindings() was called at least once
+      bool                m_is_hierarchy_mapped;        // If the last loaded class hierarchy binary was memory mapped
 
       mutable bool        m_compiled_file_b;
       mutable FString     m_compiled_path;
 
       SkookumScriptListenerManager m_listener_manager;
       SkUEReflectionManager        m_reflection_manager;
+      SkUECycleCollector           m_cycle_collector;
+      SkUEReleaseQueue             m_release_queue;
+      SkUEDemandLoadManager        m_demand_load_manager;
+
+      // Class group binaries being read ahead of demand loading - keyed by root class name id
+      TMap<uint32, TFuture<SkBinaryHandle *>> m_prefetched_class_groups;
 
       SkUEBindingsInterface *                 m_project_generated_bindings_p;
       ISkookumScriptRuntimeEditorInterface *  m_editor_interface_p;
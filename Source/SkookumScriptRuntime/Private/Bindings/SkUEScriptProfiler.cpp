@@ -0,0 +1,428 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Hierarchical profiler of script invocations entered from the plugin
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEScriptProfiler.hpp"
+#include "ISkookumScriptRuntime.h"
+#include "SkUEScriptSampler.hpp"
+#include "SkUEUtils.hpp"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+
+#include <SkookumScript/SkClass.hpp>
+#include <SkookumScript/SkInvokedMethod.hpp>
+#include <SkookumScript/SkMind.hpp>
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+namespace
+  {
+
+  // Keeps a forgotten capture from eating all memory - aggregated entries keep counting
+  const int32 c_trace_events_max = 1 << 20;
+
+  const TCHAR * const c_origin_names[SkUEScriptProfiler::Origin__count] =
+    {
+    TEXT("Blueprint"),
+    TEXT("Callback"),
+    TEXT("Delegate"),
+    TEXT("Update"),
+    TEXT("Coroutine"),
+    };
+
+  //---------------------------------------------------------------------------------------
+  // Escapes a CSV field if needed
+  FString csv_field(const FString & str)
+    {
+    if (!str.Contains(TEXT(",")) && !str.Contains(TEXT("\"")))
+      {
+      return str;
+      }
+
+    return TEXT("\"") + str.Replace(TEXT("\""), TEXT("\"\"")) + TEXT("\"");
+    }
+
+  //---------------------------------------------------------------------------------------
+  // Sk.Profile start|stop|reset|export [base path]
+  void profile_command(const TArray<FString> & args)
+    {
+    FString command = args.Num() ? args[0] : FString(TEXT("export"));
+
+    if (command == TEXT("start"))
+      {
+      SkUEScriptProfiler::enable(true);
+      }
+    else if (command == TEXT("stop"))
+      {
+      SkUEScriptProfiler::enable(false);
+      }
+    else if (command == TEXT("reset"))
+      {
+      SkUEScriptProfiler::reset();
+      }
+    else if (command == TEXT("export"))
+      {
+      FString base_path = (args.Num() > 1)
+        ? args[1]
+        : FPaths::ProfilingDir() / TEXT("SkookumScript") / (TEXT("ScriptProfile-") + FDateTime::Now().ToString());
+      SkUEScriptProfiler::export_files(base_path);
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Unknown Sk.Profile command '%s' - use start, stop, reset or export."), *command);
+      }
+    }
+
+  FAutoConsoleCommand s_profile_cmd(
+    TEXT("Sk.Profile"),
+    TEXT("SkookumScript script profiler: 'Sk.Profile start|stop|reset' or 'Sk.Profile export [base path]' to write <base path>.json (Chrome trace) and <base path>.csv."),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&profile_command));
+
+  } // End unnamed namespace
+
+//=======================================================================================
+// SkUEScriptProfiler Class Data
+//=======================================================================================
+
+bool                                     SkUEScriptProfiler::ms_is_enabled;
+uint64                                   SkUEScriptProfiler::ms_start_cycles;
+TArray<SkUEScriptProfiler::Entry>        SkUEScriptProfiler::ms_entries;
+TMap<SkUEScriptProfiler::Key, int32>     SkUEScriptProfiler::ms_entry_map;
+TMap<FString, int32>                     SkUEScriptProfiler::ms_entry_name_map;
+TArray<SkUEScriptProfiler::Frame>        SkUEScriptProfiler::ms_frames;
+TArray<int32>                            SkUEScriptProfiler::ms_update_samples;
+uint64                                   SkUEScriptProfiler::ms_pending_inclusive_cycles;
+uint64                                   SkUEScriptProfiler::ms_pending_exclusive_cycles;
+TArray<SkUEScriptProfiler::TraceEvent>   SkUEScriptProfiler::ms_trace_events;
+int64                                    SkUEScriptProfiler::ms_trace_events_dropped;
+
+//=======================================================================================
+// SkUEScriptProfiler Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Starts or stops recording - recorded data is kept until reset(). Where call tracking
+// exists the sampler is started so the update can be distributed over coroutines.
+
+void SkUEScriptProfiler::enable(bool enable_b)
+  {
+  if (enable_b && !ms_start_cycles)
+    {
+    ms_start_cycles = FPlatformTime::Cycles64();
+    }
+
+  #if (SKOOKUM & SK_DEBUG)
+    if (enable_b && !SkUEScriptSampler::is_running())
+      {
+      SkUEScriptSampler::start();
+      }
+  #endif
+
+  ms_is_enabled = enable_b;
+  UE_LOG(LogSkookum, Display, TEXT("SkookumScript script profiler %s."), enable_b ? TEXT("started") : TEXT("stopped"));
+  }
+
+//---------------------------------------------------------------------------------------
+// Discards everything recorded so far. Must not be called while scopes are open.
+
+void SkUEScriptProfiler::reset()
+  {
+  SK_ASSERTX(ms_frames.Num() == 0, "Script profiler reset while invocations are being timed.");
+
+  ms_entries.Reset();
+  ms_entry_map.Reset();
+  ms_entry_name_map.Reset();
+  ms_update_samples.Reset();
+  ms_pending_inclusive_cycles = 0u;
+  ms_pending_exclusive_cycles = 0u;
+  ms_trace_events.Reset();
+  ms_trace_events_dropped = 0;
+  ms_start_cycles = ms_is_enabled ? FPlatformTime::Cycles64() : 0u;
+  }
+
+//---------------------------------------------------------------------------------------
+// Called when invokables are about to be freed or replaced (e.g. on live update or when
+// the compiled binaries are reloaded). Recorded entries are kept and matched up again
+// by name.
+
+void SkUEScriptProfiler::forget_invokables()
+  {
+  ms_entry_map.Reset();
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes the recorded invocations as Chrome trace events (chrome://tracing, Perfetto).
+// Coroutines have no individual trace events since their time is estimated from samples.
+
+bool SkUEScriptProfiler::export_chrome_trace(const FString & path)
+  {
+  double us_per_cycle = FPlatformTime::GetSecondsPerCycle64() * 1000000.0;
+
+  FString trace;
+  TSharedRef<TJsonWriter<>> writer_p = TJsonWriterFactory<>::Create(&trace);
+  writer_p->WriteObjectStart();
+  writer_p->WriteValue(TEXT("displayTimeUnit"), TEXT("ms"));
+  writer_p->WriteArrayStart(TEXT("traceEvents"));
+  for (const TraceEvent & event : ms_trace_events)
+    {
+    const Entry & entry = ms_entries[event.m_entry_idx];
+    writer_p->WriteObjectStart();
+    writer_p->WriteValue(TEXT("name"), entry.m_invokable_name);
+    writer_p->WriteValue(TEXT("cat"), c_origin_names[entry.m_origin]);
+    writer_p->WriteValue(TEXT("ph"), TEXT("X"));
+    writer_p->WriteValue(TEXT("ts"), double(event.m_start_cycles - ms_start_cycles) * us_per_cycle);
+    writer_p->WriteValue(TEXT("dur"), double(event.m_cycles) * us_per_cycle);
+    writer_p->WriteValue(TEXT("pid"), 1);
+    writer_p->WriteValue(TEXT("tid"), 1);
+    writer_p->WriteObjectStart(TEXT("args"));
+    writer_p->WriteValue(TEXT("updater"), entry.m_updater_name);
+    writer_p->WriteObjectEnd();
+    writer_p->WriteObjectEnd();
+    }
+  writer_p->WriteArrayEnd();
+  writer_p->WriteValue(TEXT("droppedEvents"), ms_trace_events_dropped);
+  writer_p->WriteObjectEnd();
+  writer_p->Close();
+
+  return FFileHelper::SaveStringToFile(trace, *path);
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes one line per invokable/updater/origin sorted by exclusive time - coroutine rows
+// are marked as estimated since their time is distributed by samples
+
+bool SkUEScriptProfiler::export_csv(const FString & path)
+  {
+  double ms_per_cycle = FPlatformTime::GetSecondsPerCycle64() * 1000.0;
+
+  TArray<const Entry *> sorted;
+  sorted.Reserve(ms_entries.Num());
+  for (const Entry & entry : ms_entries)
+    {
+    sorted.Add(&entry);
+    }
+  sorted.Sort([](const Entry & lhs, const Entry & rhs) { return lhs.m_exclusive_cycles > rhs.m_exclusive_cycles; });
+
+  FString csv(TEXT("invokable,updater,origin,calls,samples,estimated,inclusive_ms,exclusive_ms,inclusive_ms_per_call\n"));
+  for (const Entry * entry_p : sorted)
+    {
+    double inclusive_ms = double(entry_p->m_inclusive_cycles) * ms_per_cycle;
+    csv += FString::Printf(
+      TEXT("%s,%s,%s,%lld,%lld,%d,%.4f,%.4f,%.6f\n"),
+      *csv_field(entry_p->m_invokable_name),
+      *csv_field(entry_p->m_updater_name),
+      c_origin_names[entry_p->m_origin],
+      entry_p->m_calls,
+      entry_p->m_samples,
+      entry_p->m_origin == Origin_coroutine ? 1 : 0,
+      inclusive_ms,
+      double(entry_p->m_exclusive_cycles) * ms_per_cycle,
+      entry_p->m_calls ? inclusive_ms / double(entry_p->m_calls) : 0.0);
+    }
+
+  return FFileHelper::SaveStringToFile(csv, *path);
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes <base_path>.json (Chrome trace) and <base_path>.csv (flat profile)
+
+bool SkUEScriptProfiler::export_files(const FString & base_path)
+  {
+  bool success_b = export_chrome_trace(base_path + TEXT(".json")) && export_csv(base_path + TEXT(".csv"));
+
+  if (success_b)
+    {
+    UE_LOG(LogSkookum, Display, TEXT("Wrote SkookumScript script profile to '%s.json/.csv'."), *base_path);
+    }
+  else
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("Unable to write SkookumScript script profile to '%s'."), *base_path);
+    }
+
+  return success_b;
+  }
+
+//---------------------------------------------------------------------------------------
+// Returns: index of frame to pass to exit()
+
+int32 SkUEScriptProfiler::enter(const SkInvokableBase * invokable_p, const SkInvokedBase * invoked_p, eOrigin origin)
+  {
+  int32   frame_idx = ms_frames.AddUninitialized();
+  Frame & frame = ms_frames[frame_idx];
+  SkMind * updater_p   = invoked_p ? invoked_p->get_updater() : nullptr;
+  frame.m_entry_idx    = find_or_add_entry(invokable_p, updater_p ? updater_p->get_name().get_id() : 0u, origin);
+  frame.m_child_cycles = 0u;
+  frame.m_start_cycles = FPlatformTime::Cycles64();
+  return frame_idx;
+  }
+
+//---------------------------------------------------------------------------------------
+// Pops the frame and adds its time to its entry and its parent frame
+
+void SkUEScriptProfiler::exit(int32 frame_idx, uint64 * inclusive_cycles_p, uint64 * exclusive_cycles_p)
+  {
+  uint64 end_cycles = FPlatformTime::Cycles64();
+
+  SK_ASSERTX(frame_idx == ms_frames.Num() - 1, "Script profiler scopes must be nested.");
+  Frame  frame = ms_frames.Pop(false);
+  uint64 inclusive_cycles = end_cycles - frame.m_start_cycles;
+  uint64 exclusive_cycles = inclusive_cycles - FMath::Min(frame.m_child_cycles, inclusive_cycles);
+
+  if (ms_frames.Num())
+    {
+    ms_frames.Last().m_child_cycles += inclusive_cycles;
+    }
+
+  // Entries might have been reset while this frame was open
+  if (ms_entries.IsValidIndex(frame.m_entry_idx))
+    {
+    Entry & entry = ms_entries[frame.m_entry_idx];
+    entry.m_calls++;
+    entry.m_inclusive_cycles += inclusive_cycles;
+    entry.m_exclusive_cycles += exclusive_cycles;
+
+    if (ms_trace_events.Num() < c_trace_events_max)
+      {
+      ms_trace_events.Add({frame.m_entry_idx, frame.m_start_cycles, inclusive_cycles});
+      }
+    else
+      {
+      ms_trace_events_dropped++;
+      }
+    }
+
+  if (inclusive_cycles_p)
+    {
+    *inclusive_cycles_p = inclusive_cycles;
+    *exclusive_cycles_p = exclusive_cycles;
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// Starts timing the update
+
+int32 SkUEScriptProfiler::enter_update()
+  {
+  return enter(nullptr, nullptr, Origin_update);
+  }
+
+//---------------------------------------------------------------------------------------
+// Stops timing the update - its time is kept until the samples taken during it have been
+// drained, see distribute_updates()
+
+void SkUEScriptProfiler::exit_update(int32 frame_idx)
+  {
+  uint64 inclusive_cycles;
+  uint64 exclusive_cycles;
+  exit(frame_idx, &inclusive_cycles, &exclusive_cycles);
+
+  if (SkUEScriptSampler::is_running())
+    {
+    ms_pending_inclusive_cycles += inclusive_cycles;
+    ms_pending_exclusive_cycles += exclusive_cycles;
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEScriptProfiler::add_update_sample(const SkInvokableBase * root_invokable_p, uint32_t updater_id)
+  {
+  ms_update_samples.Add(find_or_add_entry(root_invokable_p, updater_id, Origin_coroutine));
+  }
+
+//---------------------------------------------------------------------------------------
+// Splits the pending update time evenly across the samples, i.e. each coroutine gets the
+// share of its samples. Updates too short to be sampled are carried over to the next
+// one that is.
+
+void SkUEScriptProfiler::distribute_updates()
+  {
+  int32 sample_count = ms_update_samples.Num();
+  if (!sample_count)
+    {
+    return;
+    }
+
+  uint64 sample_inclusive_cycles = ms_pending_inclusive_cycles / sample_count;
+  uint64 sample_exclusive_cycles = ms_pending_exclusive_cycles / sample_count;
+  for (int32 entry_idx : ms_update_samples)
+    {
+    if (ms_entries.IsValidIndex(entry_idx))
+      {
+      Entry & entry = ms_entries[entry_idx];
+      entry.m_samples++;
+      entry.m_inclusive_cycles += sample_inclusive_cycles;
+      entry.m_exclusive_cycles += sample_exclusive_cycles;
+      }
+    }
+
+  ms_update_samples.Reset();
+  ms_pending_inclusive_cycles = 0u;
+  ms_pending_exclusive_cycles = 0u;
+  }
+
+//---------------------------------------------------------------------------------------
+// Returns: index into ms_entries for the invokable/updater/origin combination
+
+int32 SkUEScriptProfiler::find_or_add_entry(const SkInvokableBase * invokable_p, uint32_t updater_id, eOrigin origin)
+  {
+  Key key{invokable_p, updater_id, origin};
+
+  if (const int32 * entry_idx_p = ms_entry_map.Find(key))
+    {
+    return *entry_idx_p;
+    }
+
+  // First time since the invokables were forgotten - resolve names and merge by them
+  FString invokable_name = invokable_p ? AStringToFString(invokable_p->as_string_name(true)) : FString(TEXT("SkMind.update_all()"));
+  FString updater_name   = updater_id ? AStringToFString(ASymbol::create_existing(updater_id).as_str_dbg()) : FString(TEXT("(none)"));
+  FString full_name      = FString::Printf(TEXT("%s|%s|%s"), c_origin_names[origin], *updater_name, *invokable_name);
+
+  int32 entry_idx;
+  if (const int32 * entry_idx_p = ms_entry_name_map.Find(full_name))
+    {
+    entry_idx = *entry_idx_p;
+    }
+  else
+    {
+    entry_idx = ms_entries.AddZeroed();
+    Entry & entry = ms_entries[entry_idx];
+    entry.m_invokable_name = invokable_name;
+    entry.m_updater_name   = updater_name;
+    entry.m_origin         = origin;
+    ms_entry_name_map.Add(full_name, entry_idx);
+    }
+
+  ms_entry_map.Add(key, entry_idx);
+  return entry_idx;
+  }
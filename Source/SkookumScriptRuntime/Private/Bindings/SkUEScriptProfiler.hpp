@@ -0,0 +1,175 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Hierarchical profiler of script invocations entered from the plugin
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+class SkInvokableBase;
+class SkInvokedBase;
+
+//---------------------------------------------------------------------------------------
+// Records call counts plus inclusive and exclusive time per invokable, updater mind class
+// and origin of every script invocation the plugin makes - Blueprint calls, component
+// callbacks, delegates and the per-frame mind update. Nested invocations (e.g. script
+// calling a Blueprint that calls back into script) are subtracted from the exclusive
+// time of their parent.
+//
+// The prebuilt SkookumScript library does not define SKDEBUG_HOOKS and its hooks only
+// fire on entry, so coroutine time cannot be measured per coroutine. Where call tracking
+// exists (SK_DEBUG) the time of the mind update is instead distributed over the root
+// coroutines of the SkUEScriptSampler samples taken during it. These rows are estimates
+// by sample count - they have no calls, a `samples` count and are marked as estimated
+// in the CSV. Without call tracking there are no coroutine rows, only the update.
+//
+// When disabled a scope costs a single branch so it can be compiled into Development
+// builds. Toggled and exported with the `Sk.Profile` console command.
+class SkUEScriptProfiler
+  {
+  public:
+
+  // Nested Structures
+
+    enum eOrigin
+      {
+      Origin_blueprint,   // Blueprint node invoking a script method
+      Origin_callback,    // Plugin invoking a script method e.g. component events
+      Origin_delegate,    // UE delegate invoking a script closure
+      Origin_update,      // Per-frame update of all minds
+      Origin_coroutine,   // Sampled coroutine share of the per-frame update
+
+      Origin__count
+      };
+
+    struct Entry
+      {
+      FString m_invokable_name;
+      FString m_updater_name;
+      eOrigin m_origin;
+      int64   m_calls;
+      int64   m_samples;  // Samples the time of Origin_coroutine entries is estimated from
+      uint64  m_inclusive_cycles;
+      uint64  m_exclusive_cycles;
+      };
+
+    // Times the invocation from construction to destruction - the updater mind is taken
+    // from `invoked_p` (if given) which is only queried when enabled
+    class Scope
+      {
+      public:
+        Scope(const SkInvokableBase * invokable_p, const SkInvokedBase * invoked_p, eOrigin origin) : m_frame_idx(ms_is_enabled ? enter(invokable_p, invoked_p, origin) : -1) {}
+        ~Scope()                                                                                    { if (m_frame_idx >= 0) { exit(m_frame_idx); } }
+
+      protected:
+        int32 m_frame_idx;
+      };
+
+    // Times a mind update from construction to destruction - see distribute_updates()
+    class UpdateScope
+      {
+      public:
+        UpdateScope()  : m_frame_idx(ms_is_enabled ? enter_update() : -1) {}
+        ~UpdateScope() { if (m_frame_idx >= 0) { exit_update(m_frame_idx); } }
+
+      protected:
+        int32 m_frame_idx;
+      };
+
+  // Class Methods
+
+    static bool is_enabled()                     { return ms_is_enabled; }
+    static void enable(bool enable_b = true);
+    static void reset();
+    static void forget_invokables();
+
+    static const TArray<Entry> & get_entries()   { return ms_entries; }
+
+    // Called on the game thread for each drained sample taken during the update
+    static void add_update_sample(const SkInvokableBase * root_invokable_p, uint32_t updater_id);
+    // Distributes the time of the updates so far over the samples taken during them -
+    // called once per frame after the sampler has been drained
+    static void distribute_updates();
+
+    static bool export_chrome_trace(const FString & path);
+    static bool export_csv(const FString & path);
+    static bool export_files(const FString & base_path);
+
+  protected:
+
+  // Internal Structures
+
+    struct Key
+      {
+      const SkInvokableBase * m_invokable_p;
+      uint32_t                m_updater_id;
+      eOrigin                 m_origin;
+
+      bool operator==(const Key & other) const  { return m_invokable_p == other.m_invokable_p && m_updater_id == other.m_updater_id && m_origin == other.m_origin; }
+      friend uint32 GetTypeHash(const Key & key) { return HashCombine(PointerHash(key.m_invokable_p), HashCombine(key.m_updater_id, uint32(key.m_origin))); }
+      };
+
+    struct Frame
+      {
+      int32  m_entry_idx;
+      uint64 m_start_cycles;
+      uint64 m_child_cycles;
+      };
+
+    struct TraceEvent
+      {
+      int32  m_entry_idx;
+      uint64 m_start_cycles;
+      uint64 m_cycles;
+      };
+
+  // Internal Class Methods
+
+    static int32 enter(const SkInvokableBase * invokable_p, const SkInvokedBase * invoked_p, eOrigin origin);
+    static void  exit(int32 frame_idx, uint64 * inclusive_cycles_p = nullptr, uint64 * exclusive_cycles_p = nullptr);
+    static int32 enter_update();
+    static void  exit_update(int32 frame_idx);
+    static int32 find_or_add_entry(const SkInvokableBase * invokable_p, uint32_t updater_id, eOrigin origin);
+
+  // Class Data Members
+
+    static bool                 ms_is_enabled;
+    static uint64               ms_start_cycles;
+    static TArray<Entry>        ms_entries;
+    static TMap<Key, int32>     ms_entry_map;
+    static TMap<FString, int32> ms_entry_name_map;
+    static TArray<Frame>        ms_frames;
+    static TArray<int32>        ms_update_samples;  // Entries of the samples of pending updates
+    static uint64               ms_pending_inclusive_cycles;
+    static uint64               ms_pending_exclusive_cycles;
+    static TArray<TraceEvent>   ms_trace_events;
+    static int64                ms_trace_events_dropped;
+
+  };  // SkUEScriptProfiler
@@ -0,0 +1,757 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Deterministic record/replay of the engine to script boundary of a session
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEScriptReplay.hpp"
+#include "ISkookumScriptRuntime.h"
+#include "SkUEMemberLookup.hpp"
+#include "Bindings/SkUEClassBinding.hpp"
+#include "SkUEUtils.hpp"
+#include "Engine/SkUEEntity.hpp"
+#include "SkookumScriptBehaviorComponent.h"
+#include "SkookumScriptListener.h"
+
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#include <AgogCore/ARandom.hpp>
+#include <SkookumScript/SkBoolean.hpp>
+#include <SkookumScript/SkBrain.hpp>
+#include <SkookumScript/SkClass.hpp>
+#include <SkookumScript/SkInteger.hpp>
+#include <SkookumScript/SkMind.hpp>
+#include <SkookumScript/SkReal.hpp>
+#include <SkookumScript/SkRuntimeBase.hpp>
+#include <SkookumScript/SkString.hpp>
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+namespace
+  {
+
+  const uint32 c_replay_magic   = 0x50524b53; // 'SKRP'
+  const uint32 c_replay_version = 3u;
+
+  //---------------------------------------------------------------------------------------
+  // Sk.Record start [path]|stop
+  void record_command(const TArray<FString> & args)
+    {
+    FString command = args.Num() ? args[0] : FString(TEXT("start"));
+
+    if (command == TEXT("start"))
+      {
+      FString path = (args.Num() > 1)
+        ? args[1]
+        : FPaths::ProfilingDir() / TEXT("SkookumScript") / (TEXT("Session-") + FDateTime::Now().ToString() + TEXT(".skreplay"));
+      SkUEScriptReplay::start_recording(path);
+      }
+    else if (command == TEXT("stop"))
+      {
+      SkUEScriptReplay::stop_recording();
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Unknown Sk.Record command '%s' - use start or stop."), *command);
+      }
+    }
+
+  FAutoConsoleCommand s_record_cmd(
+    TEXT("Sk.Record"),
+    TEXT("SkookumScript session recording: 'Sk.Record start [path]' or 'Sk.Record stop' to write the recording for replay with 'SkookumScriptRun -replay=<path>'."),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&record_command));
+
+  } // End unnamed namespace
+
+//=======================================================================================
+// SkUEScriptReplay Class Data
+//=======================================================================================
+
+SkUEScriptReplay::eMode                                 SkUEScriptReplay::ms_mode = SkUEScriptReplay::Mode_idle;
+FString                                                 SkUEScriptReplay::ms_path;
+TArray<uint8>                                           SkUEScriptReplay::ms_data;
+int64                                                   SkUEScriptReplay::ms_read_pos;
+uint32                                                  SkUEScriptReplay::ms_call_depth;
+FString                                                 SkUEScriptReplay::ms_map;
+bool                                                    SkUEScriptReplay::ms_is_map_pending;
+TMap<const USkookumScriptListener *, uint32>            SkUEScriptReplay::ms_listener_ordinals;
+TArray<TWeakObjectPtr<USkookumScriptListener>>          SkUEScriptReplay::ms_listeners;
+uint32                                                  SkUEScriptReplay::ms_listener_count;
+uint32                                                  SkUEScriptReplay::ms_frames;
+uint32                                                  SkUEScriptReplay::ms_calls;
+uint32                                                  SkUEScriptReplay::ms_events;
+uint32                                                  SkUEScriptReplay::ms_skipped;
+bool                                                    SkUEScriptReplay::ms_diverged;
+
+//=======================================================================================
+// SkUEScriptReplay Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Starts recording to `path` - written when the recording is stopped. The random
+// generator is reseeded so the seed can be stored with the recording together with the
+// map of the current game world.
+
+void SkUEScriptReplay::start_recording(const FString & path)
+  {
+  if (ms_mode != Mode_idle)
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("Unable to start SkookumScript recording - a session is already being %s."), is_recording() ? TEXT("recorded") : TEXT("replayed"));
+    return;
+    }
+
+  reset();
+  ms_mode = Mode_record;
+  ms_path = path;
+
+  uint32 seed = ARandom::time_seed();
+  ARandom::ms_gen.set_seed(seed);
+
+  ms_map = get_map_name(SkUEClassBindingHelper::get_world());
+
+  uint32 magic   = c_replay_magic;
+  uint32 version = c_replay_version;
+  FMemoryWriter writer(ms_data, true, true);
+  writer << magic << version << seed << ms_map;
+
+  UE_LOG(LogSkookum, Display, TEXT("Recording SkookumScript session in map '%s' to '%s'."), *ms_map, *ms_path);
+  }
+
+//---------------------------------------------------------------------------------------
+// Stops recording and writes the recording to disk
+
+void SkUEScriptReplay::stop_recording()
+  {
+  if (ms_mode != Mode_record)
+    {
+    return;
+    }
+
+  uint8 record = Record_end;
+  FMemoryWriter writer(ms_data, true, true);
+  writer << record << ms_frames << ms_calls << ms_events << ms_listener_count;
+
+  if (FFileHelper::SaveArrayToFile(ms_data, *ms_path))
+    {
+    UE_LOG(LogSkookum, Display, TEXT("Wrote SkookumScript recording to '%s' - %u frames, %u calls, %u events, %u skipped."), *ms_path, ms_frames, ms_calls, ms_events, ms_skipped);
+    }
+  else
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("Unable to write SkookumScript recording to '%s'."), *ms_path);
+    }
+
+  reset();
+  }
+
+//---------------------------------------------------------------------------------------
+// Loads a recording and seeds the random generator with its seed - call before gameplay
+// is initialized, create the game world from get_map() and let replay_update() drive the
+// updates from then on
+
+bool SkUEScriptReplay::start_replay(const FString & path)
+  {
+  if (ms_mode != Mode_idle)
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("Unable to replay SkookumScript session - a session is already being %s."), is_recording() ? TEXT("recorded") : TEXT("replayed"));
+    return false;
+    }
+
+  reset();
+  ms_diverged = false;
+  if (!FFileHelper::LoadFileToArray(ms_data, *path))
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("Unable to read SkookumScript recording '%s'."), *path);
+    return false;
+    }
+
+  uint32 magic   = 0u;
+  uint32 version = 0u;
+  uint32 seed    = 0u;
+  FString map;
+  FMemoryReader reader(ms_data, true);
+  reader << magic << version;
+  if (!reader.IsError() && magic == c_replay_magic && version == c_replay_version)
+    {
+    reader << seed << map;
+    }
+  if (reader.IsError() || magic != c_replay_magic || version != c_replay_version)
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("'%s' is not a SkookumScript recording of version %u."), *path, c_replay_version);
+    reset();
+    return false;
+    }
+
+  ms_mode     = Mode_replay;
+  ms_path     = path;
+  ms_map      = map;
+  ms_read_pos = reader.Tell();
+  ARandom::ms_gen.set_seed(seed);
+
+  UE_LOG(LogSkookum, Display, TEXT("Replaying SkookumScript session '%s'."), *ms_path);
+  return true;
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEScriptReplay::stop_replay()
+  {
+  if (ms_mode != Mode_replay)
+    {
+    return;
+    }
+
+  UE_LOG(LogSkookum, Display, TEXT("Replayed SkookumScript session '%s' - %u frames, %u calls, %u events, %u skipped."), *ms_path, ms_frames, ms_calls, ms_events, ms_skipped);
+  reset();
+  }
+
+//---------------------------------------------------------------------------------------
+// #Returns
+//   true and the map in `map_p` if the replay reached a level transition - the caller
+//   replaces the game world with the map and the replay continues in it
+
+bool SkUEScriptReplay::take_map_change(FString * map_p)
+  {
+  if (ms_mode != Mode_replay || !ms_is_map_pending)
+    {
+    return false;
+    }
+
+  ms_is_map_pending = false;
+  *map_p = ms_map;
+  return true;
+  }
+
+//---------------------------------------------------------------------------------------
+// Dispatches the recorded calls and events up to the next recorded update and runs that
+// update. Stops the replay once the recording is exhausted.
+//
+// #Returns
+//   true if the runtime was updated or must not be updated until the next map is loaded,
+//   false if the caller should update it instead
+
+bool SkUEScriptReplay::replay_update()
+  {
+  if (ms_mode != Mode_replay)
+    {
+    return false;
+    }
+
+  if (ms_is_map_pending)
+    {
+    return true;
+    }
+
+  FMemoryReader reader(ms_data, true);
+  reader.Seek(ms_read_pos);
+
+  while (!reader.AtEnd() && !reader.IsError())
+    {
+    uint8 record = 0u;
+    reader << record;
+
+    switch (record)
+      {
+      case Record_update:
+        {
+        uint64 sim_ticks = 0u;
+        double sim_time  = 0.0;
+        float  sim_delta = 0.0f;
+        reader << sim_ticks << sim_time << sim_delta;
+        ms_read_pos = reader.Tell();
+        ms_frames++;
+        SkRuntimeBase::update(sim_ticks, sim_time, sim_delta);
+        return true;
+        }
+
+      case Record_call:
+        replay_call(reader);
+        break;
+
+      case Record_event:
+        replay_event(reader);
+        break;
+
+      case Record_end:
+        verify_replay(reader);
+        stop_replay();
+        return false;
+
+      case Record_map:
+        reader << ms_map;
+        ms_read_pos = reader.Tell();
+        ms_is_map_pending = !reader.IsError();
+        if (ms_is_map_pending)
+          {
+          return true;
+          }
+        break;
+
+      default:
+        reader.SetError();
+        break;
+      }
+
+    // Script may have stopped the replay
+    if (ms_mode != Mode_replay)
+      {
+      return false;
+      }
+    }
+
+  if (reader.IsError())
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("SkookumScript recording '%s' is corrupt at offset %lld."), *ms_path, reader.Tell());
+    }
+  else
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("SkookumScript recording '%s' is truncated - the replay could not be verified."), *ms_path);
+    }
+
+  stop_replay();
+  return false;
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEScriptReplay::record_call(SkInstance * receiver_p, const ASymbol & method_name, SkInstance ** args_pp, uint32_t arg_count)
+  {
+  // Calls made from within script are reproduced by script itself
+  if (SkookumScript::is_flag_set(SkookumScript::Flag_updating))
+    {
+    return;
+    }
+
+  if (arg_count > Args_max || !is_serializable(receiver_p))
+    {
+    ms_skipped++;
+    return;
+    }
+  for (uint32_t i = 0u; i < arg_count; ++i)
+    {
+    if (!is_serializable(args_pp[i]))
+      {
+      ms_skipped++;
+      return;
+      }
+    }
+
+  uint8  record    = Record_call;
+  uint32 method_id = method_name.get_id();
+  uint8  num_args  = uint8(arg_count);
+  FMemoryWriter writer(ms_data, true, true);
+  writer << record;
+  write_value(writer, receiver_p);
+  writer << method_id << num_args;
+  for (uint32_t i = 0u; i < arg_count; ++i)
+    {
+    write_value(writer, args_pp[i]);
+    }
+  ms_calls++;
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEScriptReplay::record_event(USkookumScriptListener * listener_p, SkInstance ** args_pp, uint32_t arg_count)
+  {
+  // Events raised by script calling into the engine are reproduced by script itself
+  if (SkookumScript::is_flag_set(SkookumScript::Flag_updating) || ms_call_depth)
+    {
+    return;
+    }
+
+  uint32 * ordinal_p = ms_listener_ordinals.Find(listener_p);
+  if (!ordinal_p || arg_count > Args_max)
+    {
+    ms_skipped++;
+    return;
+    }
+  for (uint32_t i = 0u; i < arg_count; ++i)
+    {
+    if (!is_serializable(args_pp[i]))
+      {
+      ms_skipped++;
+      return;
+      }
+    }
+
+  uint8 record   = Record_event;
+  uint8 num_args = uint8(arg_count);
+  FMemoryWriter writer(ms_data, true, true);
+  writer << record << *ordinal_p << num_args;
+  for (uint32_t i = 0u; i < arg_count; ++i)
+    {
+    write_value(writer, args_pp[i]);
+    }
+  ms_events++;
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEScriptReplay::record_update_internal()
+  {
+  uint8  record    = Record_update;
+  uint64 sim_ticks = SkookumScript::get_sim_ticks();
+  double sim_time  = SkookumScript::get_sim_time();
+  float  sim_delta = SkookumScript::get_sim_delta();
+  FMemoryWriter writer(ms_data, true, true);
+  writer << record << sim_ticks << sim_time << sim_delta;
+  ms_frames++;
+  }
+
+//---------------------------------------------------------------------------------------
+// Records a level transition - called before gameplay of the new world is initialized
+
+void SkUEScriptReplay::record_map(UWorld * world_p)
+  {
+  ms_map = get_map_name(world_p);
+
+  uint8 record = Record_map;
+  FMemoryWriter writer(ms_data, true, true);
+  writer << record << ms_map;
+  }
+
+//---------------------------------------------------------------------------------------
+// Package name of the world's map without the PIE prefix - empty if the world was not
+// loaded from a map
+
+FString SkUEScriptReplay::get_map_name(UWorld * world_p)
+  {
+  FString map_name = world_p ? UWorld::RemovePIEPrefix(world_p->GetOutermost()->GetName()) : FString();
+  return (!map_name.IsEmpty() && FPackageName::DoesPackageExist(map_name)) ? map_name : FString();
+  }
+
+//---------------------------------------------------------------------------------------
+// Path of the object as it is found in the map loaded outside of PIE
+
+FString SkUEScriptReplay::get_object_path(UObject * obj_p)
+  {
+  return obj_p ? UWorld::RemovePIEPrefix(obj_p->GetPathName()) : FString();
+  }
+
+//---------------------------------------------------------------------------------------
+// Numbers listeners in allocation order which is the same on replay as long as script
+// runs the same way
+
+void SkUEScriptReplay::listener_allocated(USkookumScriptListener * listener_p)
+  {
+  if (ms_mode == Mode_record)
+    {
+    ms_listener_ordinals.Add(listener_p, ms_listener_count);
+    }
+  else
+    {
+    ms_listeners.Add(listener_p);
+    }
+  ms_listener_count++;
+  }
+
+//---------------------------------------------------------------------------------------
+
+bool SkUEScriptReplay::is_serializable(SkInstance * instance_p)
+  {
+  if (instance_p == SkBrain::ms_nil_p)
+    {
+    return true;
+    }
+
+  SkClass * class_p = instance_p->get_class();
+  return class_p == SkBrain::ms_boolean_class_p
+    || class_p == SkBrain::ms_integer_class_p
+    || class_p == SkBrain::ms_real_class_p
+    || class_p == SkBrain::ms_string_class_p
+    || class_p->is_mind_class()
+    || class_p->is_class(*SkUEEntity::get_class());
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEScriptReplay::write_value(FArchive & ar, SkInstance * instance_p)
+  {
+  uint8 value_type = Value_unsupported;
+
+  if (instance_p == SkBrain::ms_nil_p)
+    {
+    value_type = Value_nil;
+    ar << value_type;
+    return;
+    }
+
+  SkClass * class_p = instance_p->get_class();
+  if (class_p == SkBrain::ms_boolean_class_p)
+    {
+    uint8 value = instance_p->as<SkBoolean>() ? 1u : 0u;
+    value_type = Value_boolean;
+    ar << value_type << value;
+    }
+  else if (class_p == SkBrain::ms_integer_class_p)
+    {
+    int32 value = instance_p->as<SkInteger>();
+    value_type = Value_integer;
+    ar << value_type << value;
+    }
+  else if (class_p == SkBrain::ms_real_class_p)
+    {
+    float value = instance_p->as<SkReal>();
+    value_type = Value_real;
+    ar << value_type << value;
+    }
+  else if (class_p == SkBrain::ms_string_class_p)
+    {
+    FString value = AStringToFString(instance_p->as<SkString>());
+    value_type = Value_string;
+    ar << value_type << value;
+    }
+  else if (class_p->is_mind_class())
+    {
+    uint32 class_id = class_p->get_name_id();
+    value_type = Value_mind;
+    ar << value_type << class_id;
+    }
+  else if (class_p->is_class(*SkUEEntity::get_class()))
+    {
+    UObject * obj_p = instance_p->as<SkUEEntity>().get_obj();
+    FString path = get_object_path(obj_p);
+    value_type = class_p->is_component_class() ? Value_component : Value_entity;
+    ar << value_type << path;
+    }
+  else
+    {
+    ar << value_type;
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+// #Returns
+//   new referenced instance or nullptr if the value could not be recreated
+
+SkInstance * SkUEScriptReplay::read_value(FArchive & ar)
+  {
+  uint8 value_type = Value_unsupported;
+  ar << value_type;
+
+  switch (value_type)
+    {
+    case Value_nil:
+      return SkBrain::ms_nil_p;
+
+    case Value_boolean:
+      {
+      uint8 value = 0u;
+      ar << value;
+      return SkBoolean::new_instance(value != 0u);
+      }
+
+    case Value_integer:
+      {
+      int32 value = 0;
+      ar << value;
+      return SkInteger::new_instance(value);
+      }
+
+    case Value_real:
+      {
+      float value = 0.0f;
+      ar << value;
+      return SkReal::new_instance(value);
+      }
+
+    case Value_string:
+      {
+      FString value;
+      ar << value;
+      return SkString::new_instance(FStringToAString(value));
+      }
+
+    case Value_mind:
+      {
+      uint32 class_id = 0u;
+      ar << class_id;
+      const AList<SkMind> & minds = SkMind::get_updating_minds();
+      for (SkMind * mind_p = minds.get_first_null(); mind_p; mind_p = minds.get_next_null(mind_p))
+        {
+        if (mind_p->get_class()->get_name_id() == class_id)
+          {
+          mind_p->reference();
+          return mind_p;
+          }
+        }
+      return nullptr;
+      }
+
+    case Value_entity:
+    case Value_component:
+      {
+      FString path;
+      ar << path;
+      UObject * obj_p = path.IsEmpty() ? nullptr : StaticFindObject(UObject::StaticClass(), nullptr, *path);
+      if (!path.IsEmpty() && !obj_p)
+        {
+        return nullptr;
+        }
+
+      if (value_type == Value_component)
+        {
+        USkookumScriptBehaviorComponent * component_p = Cast<USkookumScriptBehaviorComponent>(obj_p);
+        SkInstance * instance_p = component_p ? component_p->get_sk_component_instance() : nullptr;
+        if (instance_p)
+          {
+          instance_p->reference();
+          }
+        return instance_p;
+        }
+
+      return SkUEEntity::new_instance(obj_p);
+      }
+
+    default:
+      return nullptr;
+    }
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEScriptReplay::replay_call(FArchive & ar)
+  {
+  SkInstance * receiver_p = read_value(ar);
+  uint32 method_id = 0u;
+  uint8  num_args  = 0u;
+  ar << method_id << num_args;
+
+  SkInstance * args_p[Args_max];
+  bool is_complete = receiver_p != nullptr && num_args <= Args_max;
+  for (uint32_t i = 0u; i < num_args && i < Args_max; ++i)
+    {
+    args_p[i] = read_value(ar);
+    is_complete &= args_p[i] != nullptr;
+    }
+
+  if (!is_complete || ar.IsError())
+    {
+    for (uint32_t i = 0u; i < num_args && i < Args_max; ++i)
+      {
+      if (args_p[i]) { args_p[i]->dereference(); }
+      }
+    if (receiver_p) { receiver_p->dereference(); }
+    ms_skipped++;
+    return;
+    }
+
+  // Arguments are consumed by the call
+  SkUEMemberLookup::method_call(receiver_p, ASymbol::create_existing(method_id), args_p, num_args);
+  receiver_p->dereference();
+  ms_calls++;
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEScriptReplay::replay_event(FArchive & ar)
+  {
+  uint32 ordinal  = 0u;
+  uint8  num_args = 0u;
+  ar << ordinal << num_args;
+
+  SkInstance * args_p[Args_max];
+  bool is_complete = num_args <= Args_max;
+  for (uint32_t i = 0u; i < num_args && i < Args_max; ++i)
+    {
+    args_p[i] = read_value(ar);
+    is_complete &= args_p[i] != nullptr;
+    }
+
+  USkookumScriptListener * listener_p = (ordinal < uint32(ms_listeners.Num())) ? ms_listeners[ordinal].Get() : nullptr;
+  if (!is_complete || !listener_p || ar.IsError())
+    {
+    for (uint32_t i = 0u; i < num_args && i < Args_max; ++i)
+      {
+      if (args_p[i]) { args_p[i]->dereference(); }
+      }
+    ms_skipped++;
+    return;
+    }
+
+  USkookumScriptListener::EventInfo * event_p = USkookumScriptListener::alloc_event();
+  for (uint32_t i = 0u; i < num_args; ++i)
+    {
+    event_p->m_argument_p[i] = args_p[i];
+    }
+  listener_p->push_event_and_resume(event_p, num_args);
+  ms_events++;
+  }
+
+//---------------------------------------------------------------------------------------
+// Compares what was replayed with the counts stored at the end of the recording
+
+void SkUEScriptReplay::verify_replay(FArchive & ar)
+  {
+  uint32 frames    = 0u;
+  uint32 calls     = 0u;
+  uint32 events    = 0u;
+  uint32 listeners = 0u;
+  ar << frames << calls << events << listeners;
+
+  if (ar.IsError())
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("SkookumScript recording '%s' is corrupt at offset %lld."), *ms_path, ar.Tell());
+    return;
+    }
+
+  if (frames != ms_frames || calls != ms_calls || events != ms_events || listeners != ms_listener_count)
+    {
+    UE_LOG(LogSkookum, Error, TEXT("Replay of SkookumScript session '%s' diverged - recorded %u frames, %u calls, %u events, %u listeners but replayed %u frames, %u calls, %u events, %u listeners."),
+      *ms_path, frames, calls, events, listeners, ms_frames, ms_calls, ms_events, ms_listener_count);
+    ms_diverged = true;
+    return;
+    }
+
+  UE_LOG(LogSkookum, Display, TEXT("Replay of SkookumScript session '%s' matches the recording."), *ms_path);
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEScriptReplay::reset()
+  {
+  ms_mode           = Mode_idle;
+  ms_path.Empty();
+  ms_data.Empty();
+  ms_read_pos       = 0;
+  ms_call_depth     = 0u;
+  ms_map.Empty();
+  ms_is_map_pending = false;
+  ms_listener_ordinals.Empty();
+  ms_listeners.Empty();
+  ms_listener_count = 0u;
+  ms_frames         = 0u;
+  ms_calls          = 0u;
+  ms_events         = 0u;
+  ms_skipped        = 0u;
+  }
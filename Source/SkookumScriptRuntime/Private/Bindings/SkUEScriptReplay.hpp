@@ -0,0 +1,207 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Deterministic record/replay of the engine to script boundary of a session
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+class ASymbol;
+class FArchive;
+class SkInstance;
+class USkookumScriptListener;
+class UWorld;
+
+//---------------------------------------------------------------------------------------
+// Records everything that crosses from the engine into script during a session - the
+// simulation time of each update, engine initiated method calls and delegate events
+// received by script listeners - together with the random seed so that the session can
+// be played back without the gameplay that produced it. Replaying the file (e.g. with
+// `SkookumScriptRun -replay=<path>`) reproduces the script workload frame by frame, which
+// makes it suitable for perf regression runs.
+//
+// The map of the game world is stored with the recording and every level transition is
+// recorded, so the replay can load the same maps and find the recorded actors and
+// components in them. Object paths are stored without the PIE prefix so sessions recorded
+// in the editor replay in a standalone world.
+//
+// Only values that survive a process boundary are recorded: nil, Boolean, Integer, Real,
+// String, Entity and behavior component (by object path) and Mind (by class). Calls or
+// events that carry any other value are skipped and counted. Calls and events are only
+// recorded at the outermost level - i.e. not while script is updating or inside a
+// recorded call - since whatever script causes itself is reproduced by the script.
+//
+// The recorded frame, call, event and listener counts are stored at the end of the
+// recording and compared once a replay reaches it, so a replay that diverged from the
+// recorded session is reported rather than silently producing a different workload.
+//
+// Recording is started with `-SkRecord=<path>` - before gameplay of the first game world
+// is initialized so the seed and listener order line up - or mid-session with the
+// `Sk.Record` console command. It continues across level transitions until `Sk.Record
+// stop` or module shutdown.
+class SkUEScriptReplay
+  {
+  public:
+
+  // Class Methods
+
+    static bool is_recording()                      { return ms_mode == Mode_record; }
+    static bool is_replaying()                      { return ms_mode == Mode_replay; }
+
+    static void start_recording(const FString & path);
+    static void stop_recording();
+    static bool start_replay(const FString & path);
+    static void stop_replay();
+    static bool has_diverged()                      { return ms_diverged; }
+
+    // Map of the game world the recording started in - empty if not replaying
+    static const FString & get_map()                { return ms_map; }
+    // Returns true and the map to load once the replay reached a recorded level transition
+    static bool take_map_change(FString * map_p);
+    // Called when a new game world starts while a recording may be in progress
+    static void on_world_changed(UWorld * world_p)  { if (ms_mode == Mode_record) { record_map(world_p); } }
+
+    // Recording hooks
+    static void on_event(USkookumScriptListener * listener_p, SkInstance ** args_pp, uint32_t arg_count)
+      { if (ms_mode == Mode_record) { record_event(listener_p, args_pp, arg_count); } }
+    static void on_listener_allocated(USkookumScriptListener * listener_p)
+      { if (ms_mode != Mode_idle) { listener_allocated(listener_p); } }
+    static void record_update()                     { if (ms_mode == Mode_record) { record_update_internal(); } }
+
+    // Dispatches the recorded calls and events of the next frame and updates the runtime
+    // with its recorded time - returns false if not replaying, true while waiting for a
+    // level transition
+    static bool replay_update();
+
+  // Nested Structures
+
+    // Records an engine initiated method call - only the outermost one is recorded
+    class CallScope
+      {
+      public:
+        CallScope(SkInstance * receiver_p, const ASymbol & method_name, SkInstance ** args_pp, uint32_t arg_count)
+          : m_counted(ms_mode == Mode_record)
+          {
+          if (m_counted && ms_call_depth++ == 0u)
+            {
+            record_call(receiver_p, method_name, args_pp, arg_count);
+            }
+          }
+
+        ~CallScope()                                { if (m_counted && ms_call_depth) { --ms_call_depth; } }
+
+      protected:
+        bool m_counted;
+      };
+
+  protected:
+
+  // Internal Structures
+
+    enum eMode
+      {
+      Mode_idle,
+      Mode_record,
+      Mode_replay
+      };
+
+    enum eRecord
+      {
+      Record_update,
+      Record_call,
+      Record_event,
+      Record_end,   // Counts of the recorded session to verify the replay against
+      Record_map    // Level transition
+      };
+
+    enum eValue
+      {
+      Value_nil,
+      Value_boolean,
+      Value_integer,
+      Value_real,
+      Value_string,
+      Value_entity,
+      Value_component,
+      Value_mind,
+      Value_unsupported
+      };
+
+    enum
+      {
+      Args_max = 9  // Matches USkookumScriptListener::EventInfo
+      };
+
+  // Internal Class Methods
+
+    static void record_call(SkInstance * receiver_p, const ASymbol & method_name, SkInstance ** args_pp, uint32_t arg_count);
+    static void record_event(USkookumScriptListener * listener_p, SkInstance ** args_pp, uint32_t arg_count);
+    static void record_update_internal();
+    static void record_map(UWorld * world_p);
+    static FString get_map_name(UWorld * world_p);
+    static FString get_object_path(UObject * obj_p);
+    static void listener_allocated(USkookumScriptListener * listener_p);
+    static bool is_serializable(SkInstance * instance_p);
+    static void write_value(FArchive & ar, SkInstance * instance_p);
+    static SkInstance * read_value(FArchive & ar);
+    static void replay_call(FArchive & ar);
+    static void replay_event(FArchive & ar);
+    static void verify_replay(FArchive & ar);
+    static void reset();
+
+  // Class Data Members
+
+    static eMode                                   ms_mode;
+    static FString                                 ms_path;
+    static TArray<uint8>                           ms_data;
+    static int64                                   ms_read_pos;
+    static uint32                                  ms_call_depth;
+
+    // Map currently recorded or replayed and if a replay waits for it to be loaded
+    static FString                                 ms_map;
+    static bool                                    ms_is_map_pending;
+
+    // Listeners are pooled so events refer to them by allocation order instead - the
+    // latest ordinal of each listener when recording and every allocation when replaying
+    static TMap<const USkookumScriptListener *, uint32>    ms_listener_ordinals;
+    static TArray<TWeakObjectPtr<USkookumScriptListener>> ms_listeners;
+    static uint32                                          ms_listener_count;
+
+    static uint32                                  ms_frames;
+    static uint32                                  ms_calls;
+    static uint32                                  ms_events;
+    static uint32                                  ms_skipped;
+
+    // Set once a replay reached the end of its recording with different counts - kept
+    // after the replay stopped so the caller can check it
+    static bool                                    ms_diverged;
+
+  };  // SkUEScriptReplay
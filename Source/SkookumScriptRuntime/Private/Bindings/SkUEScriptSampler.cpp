@@ -0,0 +1,388 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Sampling profiler of the script call stack exported as folded stacks
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEScriptSampler.hpp"
+#include "ISkookumScriptRuntime.h"
+#include "SkUECostAttribution.hpp"
+#include "SkUEHeatMap.hpp"
+#include "SkUEScriptProfiler.hpp"
+#include "SkUEUtils.hpp"
+#include "Engine/SkUEEntity.hpp"
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include <SkookumScript/SkClass.hpp>
+#include <SkookumScript/SkDebug.hpp>
+#include <SkookumScript/SkExpressionBase.hpp>
+#include <SkookumScript/SkInvokableBase.hpp>
+#include <SkookumScript/SkInvokedBase.hpp>
+#include <SkookumScript/SkMind.hpp>
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+namespace
+  {
+
+  //---------------------------------------------------------------------------------------
+  // Sk.Sample start [rate hz]|stop|reset|export [path]
+  void sample_command(const TArray<FString> & args)
+    {
+    FString command = args.Num() ? args[0] : FString(TEXT("export"));
+
+    if (command == TEXT("start"))
+      {
+      SkUEScriptSampler::start((args.Num() > 1) ? FCString::Atof(*args[1]) : 1000.0f);
+      }
+    else if (command == TEXT("stop"))
+      {
+      SkUEScriptSampler::stop();
+      }
+    else if (command == TEXT("reset"))
+      {
+      SkUEScriptSampler::reset();
+      }
+    else if (command == TEXT("export"))
+      {
+      FString path = (args.Num() > 1)
+        ? args[1]
+        : FPaths::ProfilingDir() / TEXT("SkookumScript") / (TEXT("Samples-") + FDateTime::Now().ToString() + TEXT(".folded"));
+      if (SkUEScriptSampler::export_folded(path))
+        {
+        UE_LOG(LogSkookum, Display, TEXT("Wrote SkookumScript folded stacks to '%s'."), *path);
+        }
+      else
+        {
+        UE_LOG(LogSkookum, Warning, TEXT("Unable to write SkookumScript folded stacks to '%s'."), *path);
+        }
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("Unknown Sk.Sample command '%s' - use start, stop, reset or export."), *command);
+      }
+    }
+
+  FAutoConsoleCommand s_sample_cmd(
+    TEXT("Sk.Sample"),
+    TEXT("SkookumScript sampling profiler: 'Sk.Sample start [rate hz]|stop|reset' or 'Sk.Sample export [path]' to write folded stacks for flamegraph tools."),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&sample_command));
+
+  } // End unnamed namespace
+
+//=======================================================================================
+// SkUEScriptSampler Class Data
+//=======================================================================================
+
+volatile bool                                 SkUEScriptSampler::ms_is_in_update;
+SkUEScriptSampler::Worker *                   SkUEScriptSampler::ms_worker_p;
+FRunnableThread *                             SkUEScriptSampler::ms_thread_p;
+SkUEScriptSampler::Sample *                   SkUEScriptSampler::ms_ring_p;
+volatile uint32                               SkUEScriptSampler::ms_ring_head;
+volatile uint32                               SkUEScriptSampler::ms_ring_tail;
+FThreadSafeCounter64                          SkUEScriptSampler::ms_samples_taken;
+FThreadSafeCounter64                          SkUEScriptSampler::ms_samples_idle;
+FThreadSafeCounter64                          SkUEScriptSampler::ms_samples_discarded;
+TMap<SkUEScriptSampler::Stack, int64>         SkUEScriptSampler::ms_stacks;
+TMap<FString, int64>                          SkUEScriptSampler::ms_folded;
+
+//=======================================================================================
+// SkUEScriptSampler Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+
+uint32 GetTypeHash(const SkUEScriptSampler::Stack & stack)
+  {
+  uint32 hash = 0u;
+  for (const SkUEScriptSampler::Frame & frame : stack.m_frames)
+    {
+    hash = HashCombine(hash, HashCombine(PointerHash(frame.m_invokable_p), frame.m_source_idx));
+    }
+  return hash;
+  }
+
+//---------------------------------------------------------------------------------------
+// Starts the sampler thread - samples are kept until reset()
+
+void SkUEScriptSampler::start(float rate_hz)
+  {
+  #if (SKOOKUM & SK_DEBUG)
+    if (ms_thread_p)
+      {
+      return;
+      }
+
+    ms_ring_p    = new Sample[Ring_capacity];
+    ms_ring_head = 0u;
+    ms_ring_tail = 0u;
+    ms_worker_p  = new Worker(rate_hz);
+    ms_thread_p  = FRunnableThread::Create(ms_worker_p, TEXT("SkookumScriptSampler"), 0u, TPri_AboveNormal);
+
+    UE_LOG(LogSkookum, Display, TEXT("SkookumScript sampler started at %g Hz."), rate_hz);
+  #else
+    UE_LOG(LogSkookum, Warning, TEXT("The SkookumScript sampler needs call tracking which is not present in this build configuration."));
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+// Stops the sampler thread and aggregates what is left in the ring
+
+void SkUEScriptSampler::stop()
+  {
+  if (!ms_thread_p)
+    {
+    return;
+    }
+
+  ms_thread_p->Kill(true);
+  delete ms_thread_p;
+  ms_thread_p = nullptr;
+  delete ms_worker_p;
+  ms_worker_p = nullptr;
+
+  drain_internal();
+  delete [] ms_ring_p;
+  ms_ring_p = nullptr;
+
+  UE_LOG(LogSkookum, Display, TEXT("SkookumScript sampler stopped - %lld samples in script, %lld outside of script, %lld discarded."),
+    ms_samples_taken.GetValue(), ms_samples_idle.GetValue(), ms_samples_discarded.GetValue());
+  }
+
+//---------------------------------------------------------------------------------------
+// Discards everything aggregated so far
+
+void SkUEScriptSampler::reset()
+  {
+  drain();
+  ms_stacks.Reset();
+  ms_folded.Reset();
+  ms_samples_taken.Reset();
+  ms_samples_idle.Reset();
+  ms_samples_discarded.Reset();
+  }
+
+//---------------------------------------------------------------------------------------
+// Called when invokables are about to be freed or replaced (e.g. on live update or when
+// the compiled binaries are reloaded) - converts the aggregated stacks to names.
+
+void SkUEScriptSampler::forget_invokables()
+  {
+  drain();
+  resolve_stacks();
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes one `root;...;leaf count` line per distinct stack
+
+bool SkUEScriptSampler::export_folded(const FString & path)
+  {
+  drain();
+  resolve_stacks();
+
+  FString folded;
+  for (const TPair<FString, int64> & stack : ms_folded)
+    {
+    folded += FString::Printf(TEXT("%s %lld\n"), *stack.Key, stack.Value);
+    }
+
+  return FFileHelper::SaveStringToFile(folded, *path);
+  }
+
+//---------------------------------------------------------------------------------------
+// Sampler thread loop
+
+uint32 SkUEScriptSampler::Worker::Run()
+  {
+  while (!m_stop_requested)
+    {
+    FPlatformProcess::SleepNoStats(m_interval);
+    take_sample();
+    }
+
+  return 0u;
+  }
+
+//---------------------------------------------------------------------------------------
+// Called on the sampler thread - copies the current script call stack into the ring
+
+void SkUEScriptSampler::take_sample()
+  {
+  #if (SKOOKUM & SK_DEBUG)
+    AIdPtr<SkInvokedContextBase> call = SkDebug::ms_current_call_p;
+    const SkInvokedContextBase * context_p = call.get_obj();
+    if (!context_p)
+      {
+      ms_samples_idle.Increment();
+      return;
+      }
+
+    uint32 head = ms_ring_head;
+    if (head - ms_ring_tail >= uint32(Ring_capacity))
+      {
+      ms_samples_discarded.Increment();
+      return;
+      }
+
+    // The position within the leaf routine is unknown - see class comment
+    uint32_t source_idx = SkExpr_char_pos_invalid;
+
+    Sample & sample = ms_ring_p[head % Ring_capacity];
+
+    // Receiver the cost of the coroutine update is attributed to
+    sample.m_in_update = ms_is_in_update;
+    if (sample.m_in_update)
+      {
+      SkInstance * receiver_p = context_p->get_topmost_scope();
+      SkClass * class_p = receiver_p ? receiver_p->get_class() : nullptr;
+      sample.m_receiver_class_id = class_p ? class_p->get_name_id() : 0u;
+      sample.m_receiver_obj = (class_p && class_p->is_class(*SkUEEntity::get_class()))
+        ? receiver_p->as<SkUEEntity>()
+        : SkUEWeakObjectPtr<UObject>();
+      }
+
+    int32 depth = 0;
+    while (context_p && depth < Stack_depth_max)
+      {
+      Frame & frame = sample.m_frames[depth++];
+      frame.m_invokable_p = context_p->get_invokable();
+      frame.m_source_idx  = source_idx;
+
+      // Position of this call within the caller
+      source_idx = ((context_p->m_debug_info & SkDebugInfo::Flag_origin__mask) == SkDebugInfo::Flag_origin_source)
+        ? context_p->m_source_idx
+        : SkExpr_char_pos_invalid;
+      context_p = context_p->get_caller_context();
+      }
+    sample.m_depth = depth;
+
+    // Root of the stack the update time is attributed to - past the frames kept if need be
+    if (sample.m_in_update)
+      {
+      const SkInvokedContextBase * root_p = call.get_obj();
+      while (root_p->get_caller_context())
+        {
+        root_p = root_p->get_caller_context();
+        }
+      SkMind * updater_p = root_p->get_updater();
+      sample.m_root_invokable_p = root_p->get_invokable();
+      sample.m_updater_id = updater_p ? updater_p->get_name().get_id() : 0u;
+      }
+
+    // The callers walked above are only certain to be alive if the current call did not change
+    if (!(SkDebug::ms_current_call_p == call))
+      {
+      ms_samples_discarded.Increment();
+      return;
+      }
+
+    FPlatformMisc::MemoryBarrier();
+    ms_ring_head = head + 1u;
+    ms_samples_taken.Increment();
+  #endif
+  }
+
+//---------------------------------------------------------------------------------------
+// Called on the game thread outside of script execution - aggregates the ring samples
+
+void SkUEScriptSampler::drain_internal()
+  {
+  uint32 head = ms_ring_head;
+  FPlatformMisc::MemoryBarrier();
+
+  bool heat_map_b = SkUEHeatMap::is_enabled();
+  bool cost_b = SkUECostAttribution::is_enabled();
+  bool profile_b = SkUEScriptProfiler::is_enabled();
+  for (uint32 idx = ms_ring_tail; idx != head; ++idx)
+    {
+    const Sample & sample = ms_ring_p[idx % Ring_capacity];
+
+    Stack stack;
+    stack.m_frames.Append(sample.m_frames, sample.m_depth);
+    ms_stacks.FindOrAdd(stack)++;
+
+    // Innermost frame with a known position - each position belongs to its frame's routine
+    int32 site_idx = 0;
+    while (site_idx < sample.m_depth && sample.m_frames[site_idx].m_source_idx == SkExpr_char_pos_invalid)
+      {
+      ++site_idx;
+      }
+
+    if (heat_map_b && site_idx < sample.m_depth)
+      {
+      SkUEHeatMap::record(sample.m_frames[site_idx].m_invokable_p, sample.m_frames[site_idx].m_source_idx);
+      }
+
+    if (sample.m_in_update && cost_b)
+      {
+      SkUECostAttribution::add_update_sample(sample.m_receiver_class_id, sample.m_receiver_obj.get_obj());
+      }
+
+    if (sample.m_in_update && profile_b)
+      {
+      SkUEScriptProfiler::add_update_sample(sample.m_root_invokable_p, sample.m_updater_id);
+      }
+    }
+
+  FPlatformMisc::MemoryBarrier();
+  ms_ring_tail = head;
+  }
+
+//---------------------------------------------------------------------------------------
+// Converts stacks keyed by invokable pointers to folded stack names
+
+void SkUEScriptSampler::resolve_stacks()
+  {
+  for (const TPair<Stack, int64> & stack : ms_stacks)
+    {
+    FString folded;
+    for (int32 frame_idx = stack.Key.m_frames.Num() - 1; frame_idx >= 0; --frame_idx)
+      {
+      const Frame & frame = stack.Key.m_frames[frame_idx];
+      if (!folded.IsEmpty())
+        {
+        folded += TEXT(";");
+        }
+      folded += AStringToFString(frame.m_invokable_p->as_string_name(true));
+      if (frame.m_source_idx != SkExpr_char_pos_invalid)
+        {
+        folded += FString::Printf(TEXT(":%u"), frame.m_source_idx);
+        }
+      }
+
+    // Spaces would break the `stack count` format
+    folded.ReplaceInline(TEXT(" "), TEXT("_"));
+    ms_folded.FindOrAdd(folded) += stack.Value;
+    }
+
+  ms_stacks.Reset();
+  }
@@ -0,0 +1,171 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Sampling profiler of the script call stack exported as folded stacks
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+#include "Bindings/SkUEClassBinding.hpp"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+class FRunnableThread;
+class SkInvokableBase;
+
+//---------------------------------------------------------------------------------------
+// A timer thread periodically snapshots the script call stack of the game thread -
+// `SkDebug::ms_current_call_p` and its caller chain along with the position of each call
+// within its caller - into a single producer/single consumer ring buffer. The game
+// thread drains the ring after each update and aggregates the samples into folded stacks
+// (`root;caller:pos;callee count`) for flamegraph tooling and, if it is enabled, into the
+// heat map.
+//
+// The leaf is recorded as the routine only. `SkInvokedContextBase::ms_last_expr_p` is not
+// restored when a call returns, so it cannot tell where in the current routine the game
+// thread is. The heat map is therefore fed the innermost call site that is known - the
+// position in the caller of the leaf routine.
+//
+// Samples taken during the coroutine update (see UpdateScope) also record the routine at
+// the root of the stack with its updater mind and the receiver of the current call, so
+// SkUEScriptProfiler and SkUECostAttribution can distribute the time of the update over
+// the coroutines and receivers that were actually running.
+//
+// Each snapshot is validated against the id pointers of the contexts and discarded if the
+// current call changed while it was taken, so the game thread is never stopped or locked.
+// Needs SK_DEBUG (i.e. Development builds) for the call tracking - SKDEBUG_HOOKS is not
+// required. Toggled and exported with the `Sk.Sample` console command.
+class SkUEScriptSampler
+  {
+  public:
+
+  // Nested Structures
+
+    // Marks the coroutine update from construction to destruction
+    class UpdateScope
+      {
+      public:
+        UpdateScope()  { ms_is_in_update = true; }
+        ~UpdateScope() { ms_is_in_update = false; }
+      };
+
+  // Class Methods
+
+    static bool is_running()                        { return ms_thread_p != nullptr; }
+    static void start(float rate_hz = 1000.0f);
+    static void stop();
+    static void reset();
+    static void forget_invokables();
+
+    static void drain()                             { if (ms_thread_p) { drain_internal(); } }
+    static bool export_folded(const FString & path);
+
+  protected:
+
+  // Internal Structures
+
+    enum
+      {
+      Stack_depth_max   = 32,
+      Ring_capacity     = 4096
+      };
+
+    struct Frame
+      {
+      const SkInvokableBase * m_invokable_p;
+      uint32_t                m_source_idx;
+
+      bool operator==(const Frame & other) const { return m_invokable_p == other.m_invokable_p && m_source_idx == other.m_source_idx; }
+      };
+
+    // Frames are stored leaf first
+    struct Sample
+      {
+      int32 m_depth;
+      Frame m_frames[Stack_depth_max];
+
+      // Set if taken during the coroutine update - root routine of the stack and its
+      // updater mind for SkUEScriptProfiler, receiver of the current call for
+      // SkUECostAttribution
+      bool                         m_in_update;
+      const SkInvokableBase *      m_root_invokable_p;
+      uint32                       m_updater_id;
+      uint32                       m_receiver_class_id;
+      SkUEWeakObjectPtr<UObject>   m_receiver_obj;
+      };
+
+    struct Stack
+      {
+      TArray<Frame> m_frames;
+
+      bool operator==(const Stack & other) const { return m_frames == other.m_frames; }
+      friend uint32 GetTypeHash(const Stack & stack);
+      };
+
+    class Worker : public FRunnable
+      {
+      public:
+        Worker(float rate_hz) : m_interval(1.0f / FMath::Max(rate_hz, 1.0f)) {}
+
+        virtual uint32 Run() override;
+        virtual void   Stop() override  { m_stop_requested = true; }
+
+      protected:
+        float           m_interval;
+        FThreadSafeBool m_stop_requested;
+      };
+
+  // Internal Class Methods
+
+    static void take_sample();
+    static void drain_internal();
+    static void resolve_stacks();
+
+  // Class Data Members
+
+    static volatile bool        ms_is_in_update;
+    static Worker *             ms_worker_p;
+    static FRunnableThread *    ms_thread_p;
+
+    // Ring buffer - only the sampler thread writes ms_ring_head and only the game thread
+    // writes ms_ring_tail
+    static Sample *             ms_ring_p;
+    static volatile uint32      ms_ring_head;
+    static volatile uint32      ms_ring_tail;
+
+    static FThreadSafeCounter64 ms_samples_taken;
+    static FThreadSafeCounter64 ms_samples_idle;
+    static FThreadSafeCounter64 ms_samples_discarded;
+
+    // Aggregated on the game thread - by pointer until invokables are forgotten then by name
+    static TMap<Stack, int64>   ms_stacks;
+    static TMap<FString, int64> ms_folded;
+
+  };  // SkUEScriptSampler
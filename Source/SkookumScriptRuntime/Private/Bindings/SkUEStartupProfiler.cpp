@@ -0,0 +1,275 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Per-phase timing of SkookumScript startup with regression check against a baseline
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkUEStartupProfiler.hpp"
+#include "ISkookumScriptRuntime.h"
+
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+//=======================================================================================
+// Local Global Structures
+//=======================================================================================
+
+namespace
+  {
+
+  // Phases that got slower by less than this are treated as noise
+  const double c_regression_min_ms = 1.0;
+
+  // Editor sessions may go on for a long time without a game world being initialized -
+  // keeps the phases of e.g. repeated Blueprint compiles from piling up
+  const int32 c_phases_max = 4096;
+
+  } // End unnamed namespace
+
+//=======================================================================================
+// SkUEStartupProfiler Class Data
+//=======================================================================================
+
+bool           SkUEStartupProfiler::ms_is_recording = true;
+uint32_t       SkUEStartupProfiler::ms_depth;
+TArray<SkUEStartupProfiler::Phase> SkUEStartupProfiler::ms_phases;
+volatile int64 SkUEStartupProfiler::ms_alloc_count;
+volatile int64 SkUEStartupProfiler::ms_alloc_bytes;
+
+//=======================================================================================
+// SkUEStartupProfiler Class Methods
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Returns: index of phase to pass to end_phase() or INDEX_NONE if not recording
+
+int32 SkUEStartupProfiler::begin_phase(const TCHAR * name_p)
+  {
+  if (!ms_is_recording || ms_phases.Num() >= c_phases_max)
+    {
+    return INDEX_NONE;
+    }
+
+  int32 phase_idx = ms_phases.AddZeroed();
+  Phase & phase = ms_phases[phase_idx];
+  phase.m_name_p      = name_p;
+  phase.m_depth       = ms_depth++;
+  phase.m_alloc_count = ms_alloc_count;
+  phase.m_alloc_bytes = ms_alloc_bytes;
+  phase.m_start_time  = FPlatformTime::Seconds();
+  return phase_idx;
+  }
+
+//---------------------------------------------------------------------------------------
+
+void SkUEStartupProfiler::end_phase(int32 phase_idx)
+  {
+  // Recording might have been finished while the phase was running
+  if (phase_idx == INDEX_NONE || !ms_is_recording)
+    {
+    return;
+    }
+
+  Phase & phase = ms_phases[phase_idx];
+  phase.m_seconds     = FPlatformTime::Seconds() - phase.m_start_time;
+  phase.m_alloc_count = ms_alloc_count - phase.m_alloc_count;
+  phase.m_alloc_bytes = ms_alloc_bytes - phase.m_alloc_bytes;
+  ms_depth--;
+  }
+
+//---------------------------------------------------------------------------------------
+// Stops recording. If `report_path` is given, writes the recorded phases as JSON to it.
+// If `baseline_path` names the report of an earlier run, phases that took more than
+// `max_regression_pct` percent longer than in the baseline are logged as regressions.
+// 
+// Returns: false if any phase regressed
+bool SkUEStartupProfiler::finish(const FString & report_path, const FString & baseline_path, float max_regression_pct)
+  {
+  if (!ms_is_recording)
+    {
+    return true;
+    }
+
+  // Close phases still open so they are reported with the time so far
+  for (int32 phase_idx = ms_phases.Num() - 1; ms_depth && phase_idx >= 0; phase_idx--)
+    {
+    if (ms_phases[phase_idx].m_depth == ms_depth - 1u && ms_phases[phase_idx].m_seconds == 0.0)
+      {
+      end_phase(phase_idx);
+      }
+    }
+  ms_is_recording = false;
+
+  TMap<FString, double> baseline_ms;
+  if (!baseline_path.IsEmpty() && !load_baseline(baseline_path, &baseline_ms))
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("SkookumScript startup profile - unable to read baseline '%s'!"), *baseline_path);
+    }
+
+  TArray<FString> regressions;
+  FString report = make_report(baseline_ms, max_regression_pct, &regressions);
+  if (!report_path.IsEmpty())
+    {
+    if (FFileHelper::SaveStringToFile(report, *report_path))
+      {
+      UE_LOG(LogSkookum, Display, TEXT("SkookumScript startup profile written to '%s'."), *report_path);
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Warning, TEXT("SkookumScript startup profile - unable to write '%s'!"), *report_path);
+      }
+    }
+
+  for (const FString & regression : regressions)
+    {
+    UE_LOG(LogSkookum, Warning, TEXT("SkookumScript startup regression: %s"), *regression);
+    }
+
+  ms_phases.Empty();
+  return regressions.Num() == 0;
+  }
+
+//---------------------------------------------------------------------------------------
+// Builds JSON report of recorded phases:
+//   phases       - every recorded phase in start order with its nesting depth
+//   totals       - per phase name summed over all times it ran - used for comparison
+//   regressions  - phase names that regressed compared to the baseline
+FString SkUEStartupProfiler::make_report(const TMap<FString, double> & baseline_ms, float max_regression_pct, TArray<FString> * regressions_p)
+  {
+  struct Total
+    {
+    double m_ms = 0.0;
+    int64  m_alloc_count = 0;
+    int64  m_alloc_bytes = 0;
+    int32  m_count = 0;
+    };
+
+  TMap<FString, Total> totals;
+  double total_ms = 0.0;
+  double first_start_time = ms_phases.Num() ? ms_phases[0].m_start_time : 0.0;
+
+  FString report;
+  TSharedRef<TJsonWriter<>> writer_p = TJsonWriterFactory<>::Create(&report);
+  writer_p->WriteObjectStart();
+
+  writer_p->WriteArrayStart(TEXT("phases"));
+  for (const Phase & phase : ms_phases)
+    {
+    double phase_ms = phase.m_seconds * 1000.0;
+    writer_p->WriteObjectStart();
+    writer_p->WriteValue(TEXT("name"), phase.m_name_p);
+    writer_p->WriteValue(TEXT("depth"), int32(phase.m_depth));
+    writer_p->WriteValue(TEXT("start_ms"), (phase.m_start_time - first_start_time) * 1000.0);
+    writer_p->WriteValue(TEXT("ms"), phase_ms);
+    writer_p->WriteValue(TEXT("allocs"), phase.m_alloc_count);
+    writer_p->WriteValue(TEXT("alloc_bytes"), phase.m_alloc_bytes);
+    writer_p->WriteObjectEnd();
+
+    Total & total = totals.FindOrAdd(phase.m_name_p);
+    total.m_ms += phase_ms;
+    total.m_alloc_count += phase.m_alloc_count;
+    total.m_alloc_bytes += phase.m_alloc_bytes;
+    total.m_count++;
+
+    if (phase.m_depth == 0u)
+      {
+      total_ms += phase_ms;
+      }
+    }
+  writer_p->WriteArrayEnd();
+
+  writer_p->WriteObjectStart(TEXT("totals"));
+  for (const TPair<FString, Total> & total : totals)
+    {
+    writer_p->WriteObjectStart(total.Key);
+    writer_p->WriteValue(TEXT("ms"), total.Value.m_ms);
+    writer_p->WriteValue(TEXT("allocs"), total.Value.m_alloc_count);
+    writer_p->WriteValue(TEXT("alloc_bytes"), total.Value.m_alloc_bytes);
+    writer_p->WriteValue(TEXT("count"), total.Value.m_count);
+    writer_p->WriteObjectEnd();
+
+    const double * baseline_ms_p = baseline_ms.Find(total.Key);
+    if (baseline_ms_p
+      && total.Value.m_ms > *baseline_ms_p * (1.0 + max_regression_pct / 100.0)
+      && total.Value.m_ms - *baseline_ms_p >= c_regression_min_ms)
+      {
+      regressions_p->Add(FString::Printf(TEXT("%s took %.1fms - baseline %.1fms"), *total.Key, total.Value.m_ms, *baseline_ms_p));
+      }
+    }
+  writer_p->WriteObjectEnd();
+
+  writer_p->WriteValue(TEXT("total_ms"), total_ms);
+  writer_p->WriteValue(TEXT("max_regression_pct"), max_regression_pct);
+  writer_p->WriteArrayStart(TEXT("regressions"));
+  for (const FString & regression : *regressions_p)
+    {
+    writer_p->WriteValue(regression);
+    }
+  writer_p->WriteArrayEnd();
+
+  writer_p->WriteObjectEnd();
+  writer_p->Close();
+
+  return report;
+  }
+
+//---------------------------------------------------------------------------------------
+// Reads per phase name totals from a report written by an earlier run
+
+bool SkUEStartupProfiler::load_baseline(const FString & baseline_path, TMap<FString, double> * baseline_ms_p)
+  {
+  FString baseline;
+  if (!FFileHelper::LoadFileToString(baseline, *baseline_path))
+    {
+    return false;
+    }
+
+  TSharedPtr<FJsonObject> root_p;
+  if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(baseline), root_p) || !root_p.IsValid())
+    {
+    return false;
+    }
+
+  const TSharedPtr<FJsonObject> * totals_pp = nullptr;
+  if (!root_p->TryGetObjectField(TEXT("totals"), totals_pp))
+    {
+    return false;
+    }
+
+  for (const TPair<FString, TSharedPtr<FJsonValue>> & total : (*totals_pp)->Values)
+    {
+    const TSharedPtr<FJsonObject> * total_pp = nullptr;
+    double ms;
+    if (total.Value->TryGetObject(total_pp) && (*total_pp)->TryGetNumberField(TEXT("ms"), ms))
+      {
+      baseline_ms_p->Add(total.Key, ms);
+      }
+    }
+
+  return true;
+  }
@@ -0,0 +1,91 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Per-phase timing of SkookumScript startup with regression check against a baseline
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "CoreMinimal.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+// Records wall time, number of SkookumScript allocations and allocated bytes of each
+// startup phase marked with a Scope. Recording starts when the module is loaded and stops
+// with finish() once the first game world has been initialized - after that scopes cost
+// a single branch.
+//
+// finish() can write the phases as JSON and compare them against the JSON of an earlier
+// run to catch boot time regressions.
+class SkUEStartupProfiler
+  {
+  public:
+
+    struct Phase
+      {
+      const TCHAR * m_name_p;
+      uint32_t      m_depth;
+      double        m_start_time;
+      double        m_seconds;
+      int64         m_alloc_count;
+      int64         m_alloc_bytes;
+      };
+
+    // Times the phase from construction to destruction
+    class Scope
+      {
+      public:
+        Scope(const TCHAR * name_p) : m_phase_idx(begin_phase(name_p)) {}
+        ~Scope()                                                       { end_phase(m_phase_idx); }
+
+      protected:
+        int32 m_phase_idx;
+      };
+
+  // Class Methods
+
+    static bool  is_recording()              { return ms_is_recording; }
+    static void  on_alloc(size_t size)       { if (ms_is_recording) { FPlatformAtomics::InterlockedIncrement(&ms_alloc_count); FPlatformAtomics::InterlockedAdd(&ms_alloc_bytes, int64(size)); } }
+
+    static int32 begin_phase(const TCHAR * name_p);
+    static void  end_phase(int32 phase_idx);
+    static bool  finish(const FString & report_path, const FString & baseline_path, float max_regression_pct);
+
+  protected:
+
+    static FString make_report(const TMap<FString, double> & baseline_ms, float max_regression_pct, TArray<FString> * regressions_p);
+    static bool    load_baseline(const FString & baseline_path, TMap<FString, double> * baseline_ms_p);
+
+  // Class Data Members
+
+    static bool           ms_is_recording;
+    static uint32_t       ms_depth;
+    static TArray<Phase>  ms_phases;
+    static volatile int64 ms_alloc_count;
+    static volatile int64 ms_alloc_bytes;
+
+  };  // SkUEStartupProfiler
@@ -28,6 +28,8 @@
 
 #include "SkookumScriptBehaviorComponent.h"
 #include "Bindings/Engine/SkUESkookumScriptBehaviorComponent.hpp"
+#include "Bindings/SkUECycleCollector.hpp"
+#include "Bindings/SkUEMemberLookup.hpp"
 
 #include "VectorField/VectorField.h" // HACK to fix broken dependency on UVectorField 
 #include <SkUEEEndPlayReason.generated.hpp>
@@ -126,7 +128,7 @@ void USkookumScriptBehaviorComponent::delete_sk_instance()
   {
   SK_ASSERTX(m_component_instance_p, "No Sk instance to delete!");
   m_component_instance_p->abort_coroutines_on_this();
-  m_component_instance_p->dereference();
+  SkUECycleCollector::release(m_component_instance_p);
   m_component_instance_p = nullptr;
   }
 
@@ -187,7 +189,7 @@ void USkookumScriptBehaviorComponent::InitializeComponent()
       }
 
     m_component_instance_p->as<SkUESkookumScriptBehaviorComponent>() = this;
-    m_component_instance_p->method_call(ms_symbol_on_attach);
+    SkUEMemberLookup::method_call(m_component_instance_p, ms_symbol_on_attach);
     }
   }
 
@@ -203,7 +205,7 @@ void USkookumScriptBehaviorComponent::BeginPlay()
     SK_ASSERTX(m_component_instance_p.is_valid(), a_str_format("SkookumScriptBehaviorComponent '%S' on actor '%S' has no SkookumScript instance upon BeginPlay. This means its InitializeComponent() method was never called during initialization. Please check your initialization sequence and make sure this component gets properly initialized.", *GetName(), *GetOwner()->GetName()));
     if (m_component_instance_p.is_valid())
       {
-      m_component_instance_p->method_call(ms_symbol_on_begin_play);
+      SkUEMemberLookup::method_call(m_component_instance_p, ms_symbol_on_begin_play);
       }
     }
   }
@@ -214,7 +216,7 @@ void USkookumScriptBehaviorComponent::EndPlay(const EEndPlayReason::Type end_pla
   {
   if (m_component_instance_p.is_valid())
     {
-    m_component_instance_p->method_call(ms_symbol_on_end_play, SkUEEEndPlayReason::new_instance(end_play_reason));
+    SkUEMemberLookup::method_call(m_component_instance_p, ms_symbol_on_end_play, SkUEEEndPlayReason::new_instance(end_play_reason));
     }
 
   Super::EndPlay(end_play_reason);
@@ -229,12 +231,12 @@ void USkookumScriptBehaviorComponent::UninitializeComponent()
     {
     SK_MAD_ASSERTX(SkookumScript::get_initialization_level() >= SkookumScript::InitializationLevel_gameplay, "SkookumScript must be in gameplay mode when UninitializeComponent() is invoked.");
 
-    m_component_instance_p->method_call(ms_symbol_on_detach);
+    SkUEMemberLookup::method_call(m_component_instance_p, ms_symbol_on_detach);
     m_component_instance_p->as<SkUESkookumScriptBehaviorComponent>() = nullptr;
 
     if (m_is_instance_externally_owned)
       {
-      m_component_instance_p->dereference();
+      SkUECycleCollector::release(m_component_instance_p);
       m_component_instance_p = nullptr;
       m_is_instance_externally_owned = false;
       }
@@ -29,6 +29,7 @@
 #include "SkookumScriptClassDataComponent.h"
 #include "SkookumScriptInstanceProperty.h"
 #include "Bindings/Engine/SkUEActor.hpp"
+#include "Bindings/SkUECycleCollector.hpp"
 
 #include "Engine/World.h"
 #include "Runtime/Launch/Resources/Version.h" // TEMP HACK for ENGINE_MINOR_VERSION
@@ -158,7 +159,7 @@ void USkookumScriptClassDataComponent::delete_sk_instance()
   {
   SK_ASSERTX(m_actor_instance_p, "No Sk instance to delete!");
   m_actor_instance_p->abort_coroutines_on_this();
-  m_actor_instance_p->dereference();
+  SkUECycleCollector::release(m_actor_instance_p);
   m_actor_instance_p = nullptr;
   }
 
@@ -29,6 +29,8 @@
 #include "SkookumScriptClassDataComponent.h"
 #include "SkookumScriptConstructionComponent.h"
 #include "Bindings/SkUEClassBinding.hpp"
+#include "Bindings/SkUECycleCollector.hpp"
+#include "Bindings/SkUEDemandLoadManager.hpp"
 #include "SkUEEntity.generated.hpp"
 
 #include <SkookumScript/SkInstance.hpp>
@@ -69,6 +71,7 @@ SkInstance * USkookumScriptInstanceProperty::construct_instance(void * data_p, U
   set_instance(data_p, instance_p);                     // Store SkInstance in object
   instance_p->call_default_constructor();               // Call script constructor    
   instance_p->construct<SkUEEntity>(obj_p);             // Initialize object pointer a second time as the default constructor might have overclobbered it (e.g. SkookumScriptBehaviorComponent)
+  SkUEDemandLoadManager::get()->touch(*sk_class_p);     // Class group is in use
   return instance_p;
   }
 
@@ -82,7 +85,7 @@ void USkookumScriptInstanceProperty::destroy_instance(void * data_p)
     instance_p->abort_coroutines_on_this();
     // Destructor not explicitly called here as it will be automagically called 
     // when the instance is dereferenced to zero
-    instance_p->dereference();
+    SkUECycleCollector::release(instance_p);
     // Zero the pointer so it's fresh in case UE4 wants to recycle this object
     set_instance(data_p, nullptr);
     }
@@ -29,11 +29,15 @@
 #include "SkookumScriptListenerManager.hpp"
 #include "Bindings/VectorMath/SkVector3.hpp"
 #include "Bindings/Engine/SkUEName.hpp"
+#include "Bindings/SkUECostAttribution.hpp"
+#include "Bindings/SkUEScriptProfiler.hpp"
+#include "Bindings/SkUEScriptReplay.hpp"
 #include <SkUEEntity.generated.hpp>
 
 #include <SkookumScript/SkBoolean.hpp>
 #include <SkookumScript/SkClosure.hpp>
 #include <SkookumScript/SkInvokedCoroutine.hpp>
+#include <SkookumScript/SkLiteralClosure.hpp>
 
 //=======================================================================================
 // FSkookumScriptListenerAutoPtr
@@ -122,6 +126,7 @@ void USkookumScriptListener::push_event_and_resume(EventInfo * event_p, uint32_t
     for (uint32_t i = num_arguments; i < A_COUNT_OF(event_p->m_argument_p); ++i) SK_ASSERTX(!event_p->m_argument_p[i], "Unused event arguments must be left alone.");
     SK_ASSERTX(m_num_arguments == 0 || m_num_arguments == num_arguments, "All events must have same argument count.");
   #endif
+  SkUEScriptReplay::on_event(this, event_p->m_argument_p, num_arguments);
   m_num_arguments = num_arguments;
   m_event_queue.append(event_p);
   if (m_coro_p.is_valid()) m_coro_p->resume();
@@ -174,7 +179,11 @@ bool USkookumScriptListener::coro_on_event_do(SkInvokedCoroutine * scope_p, tReg
         event_p->m_argument_p[SkArg_1 + i]->reference();
         }
       }
-    closure_p->closure_method_call(&event_p->m_argument_p[0], listener_p->get_num_arguments(), &closure_result_p, scope_p);
+      {
+      SkUEScriptProfiler::Scope profile(closure_p->get_info()->get_invokable(), scope_p, SkUEScriptProfiler::Origin_delegate);
+      SkUECostAttribution::Scope cost(closure_p->get_receiver());
+      closure_p->closure_method_call(&event_p->m_argument_p[0], listener_p->get_num_arguments(), &closure_result_p, scope_p);
+      }
     if (do_until)
       {
       exit = closure_result_p->as<SkBoolean>();
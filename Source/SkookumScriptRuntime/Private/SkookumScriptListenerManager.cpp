@@ -26,6 +26,7 @@
 
 #include "SkookumScriptListenerManager.hpp"
 #include "Bindings/SkUERuntime.hpp"
+#include "Bindings/SkUEScriptReplay.hpp"
 
 #include <SkookumScript/SkDebug.hpp>
 
@@ -93,6 +94,7 @@ USkookumScriptListener * SkookumScriptListenerManager::alloc_listener(UObject *
   USkookumScriptListener * delegate_obj = m_inactive_list.pop_last();
   delegate_obj->initialize(obj_p, coro_p, callback_p);
   m_active_list.append(*delegate_obj);
+  SkUEScriptReplay::on_listener_allocated(delegate_obj);
   return delegate_obj;
   }
 
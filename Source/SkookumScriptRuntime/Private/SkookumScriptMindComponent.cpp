@@ -26,6 +26,7 @@
 //=======================================================================================
 
 #include "SkookumScriptMindComponent.h"
+#include "Bindings/SkUECycleCollector.hpp"
 #include "GameFramework/Actor.h"
 #include "Engine/World.h"
 #include "Runtime/Launch/Resources/Version.h" // TEMP HACK for ENGINE_MINOR_VERSION
@@ -91,7 +92,7 @@ void USkookumScriptMindComponent::delete_sk_instance()
   SK_ASSERTX(m_mind_instance_p, "No Sk instance to delete!");
   static_cast<SkMind *>(m_mind_instance_p.get_obj())->abort_coroutines();
   m_mind_instance_p->abort_coroutines_on_this();
-  m_mind_instance_p->dereference();
+  SkUECycleCollector::release(m_mind_instance_p);
   m_mind_instance_p = nullptr;
   }
 
@@ -0,0 +1,300 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Commandlet running the startup class headless with a fixed sim delta
+//=======================================================================================
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "SkookumScriptRunCommandlet.h"
+#include "ISkookumScriptRuntime.h"
+#include "Bindings/SkUEDemandLoadManager.hpp"
+#include "Bindings/SkUEMemberLookup.hpp"
+#include "Bindings/SkUERuntime.hpp"
+#include "Bindings/SkUEScriptProfiler.hpp"
+#include "Bindings/SkUEScriptReplay.hpp"
+#include "Bindings/SkUEUtils.hpp"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Modules/ModuleManager.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/Package.h"
+
+#include <SkookumScript/SkClass.hpp>
+#include <SkookumScript/SkMind.hpp>
+
+//=======================================================================================
+// Method Definitions
+//=======================================================================================
+
+//---------------------------------------------------------------------------------------
+
+USkookumScriptRunCommandlet::USkookumScriptRunCommandlet(const FObjectInitializer & ObjectInitializer)
+  : Super(ObjectInitializer)
+  {
+  IsClient = false;
+  IsEditor = false;
+  IsServer = false;
+  LogToConsole = true;
+  }
+
+//---------------------------------------------------------------------------------------
+
+int32 USkookumScriptRunCommandlet::Main(const FString & params)
+  {
+  int32   frames = 600;
+  float   delta = 1.0f / 30.0f;
+  int32   evict_every = 0;
+  FString coroutine_name;
+  FString report_path;
+  FString script_profile_path;
+  FString replay_path;
+
+  FParse::Value(*params, TEXT("frames="), frames);
+  FParse::Value(*params, TEXT("delta="), delta);
+  FParse::Value(*params, TEXT("coroutine="), coroutine_name);
+  FParse::Value(*params, TEXT("report="), report_path);
+  FParse::Value(*params, TEXT("scriptprofile="), script_profile_path);
+  FParse::Value(*params, TEXT("replay="), replay_path);
+  FParse::Value(*params, TEXT("evictevery="), evict_every);
+
+  ISkookumScriptRuntime & runtime = FModuleManager::LoadModuleChecked<ISkookumScriptRuntime>("SkookumScriptRuntime");
+  // Module startup only loads the binaries - binding and gameplay initialization happen when the first game world is created
+  SkUERuntime * sk_runtime_p = SkUERuntime::get_singleton();
+  if (runtime.is_skookum_disabled() || !sk_runtime_p || !sk_runtime_p->is_compiled_scripts_loaded())
+    {
+    UE_LOG(LogSkookum, Error, TEXT("SkookumScript is not available - make sure the compiled binaries exist and load without errors."));
+    return 1;
+    }
+
+  // The recording is loaded first so its seed is in place when gameplay is initialized
+  if (!replay_path.IsEmpty() && !SkUEScriptReplay::start_replay(replay_path))
+    {
+    return 1;
+    }
+
+  // Creating a game world initializes gameplay and with it the master mind of the startup
+  // class - replays load the recorded map so the recorded actors and components exist
+  UWorld * world_p = create_world(SkUEScriptReplay::get_map());
+  if (!world_p)
+    {
+    SkUEScriptReplay::stop_replay();
+    return 1;
+    }
+
+  SkMind * master_mind_p = SkookumScript::get_master_mind();
+  int32    result = 0;
+
+  if (SkookumScript::get_initialization_level() < SkookumScript::InitializationLevel_gameplay || !master_mind_p)
+    {
+    UE_LOG(LogSkookum, Error, TEXT("SkookumScript gameplay did not initialize with the game world - see log for binding errors."));
+    result = 1;
+    }
+  else if (!coroutine_name.IsEmpty())
+    {
+    ASymbol coroutine_sym = FStringToASymbol(coroutine_name);
+    if (SkUEMemberLookup::find_coroutine_inherited(master_mind_p->get_class(), coroutine_sym))
+      {
+      SkUEMemberLookup::coroutine_call(master_mind_p, coroutine_sym);
+      }
+    else
+      {
+      UE_LOG(LogSkookum, Error, TEXT("Coroutine '%s' not found on the master mind."), *coroutine_name);
+      result = 1;
+      }
+    }
+
+  if (result == 0)
+    {
+    UE_LOG(LogSkookum, Display, TEXT("Running SkookumScript for up to %d frames with a fixed delta of %g s."), frames, delta);
+
+    TArray<double> frame_seconds;
+    frame_seconds.Reserve(FMath::Max(frames, 0));
+
+    if (!script_profile_path.IsEmpty())
+      {
+      SkUEScriptProfiler::reset();
+      SkUEScriptProfiler::enable(true);
+      }
+
+    double run_start_time = FPlatformTime::Seconds();
+    for (int32 frame = 0; frame < frames; ++frame)
+      {
+      double frame_start_time = FPlatformTime::Seconds();
+      world_p->Tick(LEVELTICK_All, delta);
+      frame_seconds.Add(FPlatformTime::Seconds() - frame_start_time);
+
+      // Follow the level transitions of the recorded session
+      FString map_name;
+      if (SkUEScriptReplay::take_map_change(&map_name))
+        {
+        destroy_world(world_p);
+        world_p = create_world(map_name);
+        if (!world_p)
+          {
+          result = 1;
+          break;
+          }
+        master_mind_p = SkookumScript::get_master_mind();
+        }
+
+      // Soak evicting and reloading demand-loaded class groups
+      if (evict_every > 0 && (frame + 1) % evict_every == 0)
+        {
+        SkUEDemandLoadManager::get()->evict_all();
+        }
+
+      if (!coroutine_name.IsEmpty() && !master_mind_p->is_active())
+        {
+        break;
+        }
+
+      // Replays run until the recording is exhausted
+      if (!replay_path.IsEmpty() && !SkUEScriptReplay::is_replaying())
+        {
+        break;
+        }
+      }
+    SkUEScriptReplay::stop_replay();
+    if (!replay_path.IsEmpty() && SkUEScriptReplay::has_diverged())
+      {
+      result = 1;
+      }
+    double wall_seconds = FPlatformTime::Seconds() - run_start_time;
+
+    if (!script_profile_path.IsEmpty())
+      {
+      SkUEScriptProfiler::enable(false);
+      if (!SkUEScriptProfiler::export_files(script_profile_path))
+        {
+        result = 1;
+        }
+      }
+
+    UE_LOG(LogSkookum, Display, TEXT("Ran %d frames in %.3f s."), frame_seconds.Num(), wall_seconds);
+
+    const SkUEDemandLoadManager::Stats & demand_stats = SkUEDemandLoadManager::get()->get_stats();
+    if (demand_stats.m_loads)
+      {
+      UE_LOG(LogSkookum, Display, TEXT("Demand-loaded class groups: %u loads, %u reloads, %u evictions, %u deferred, %u groups with %u bytes loaded."),
+        demand_stats.m_loads, demand_stats.m_reloads, demand_stats.m_evictions, demand_stats.m_deferrals, demand_stats.m_groups_loaded, demand_stats.m_bytes_loaded);
+      }
+
+    if (!report_path.IsEmpty() && !write_report(report_path, frame_seconds, delta, wall_seconds))
+      {
+      UE_LOG(LogSkookum, Error, TEXT("Unable to write run report '%s'."), *report_path);
+      result = 1;
+      }
+    }
+
+  // Cleaning up the world deinitializes gameplay again
+  if (world_p)
+    {
+    destroy_world(world_p);
+    }
+
+  return result;
+  }
+
+//---------------------------------------------------------------------------------------
+// Creates and begins play of a game world - loaded from `map_name` or empty if no map is
+// given. Returns nullptr if the map could not be loaded.
+UWorld * USkookumScriptRunCommandlet::create_world(const FString & map_name) const
+  {
+  UWorld * world_p = nullptr;
+
+  if (map_name.IsEmpty())
+    {
+    world_p = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SkookumScriptRun"));
+    }
+  else
+    {
+    UPackage * package_p = LoadPackage(nullptr, *map_name, LOAD_None);
+    world_p = package_p ? UWorld::FindWorldInPackage(package_p) : nullptr;
+    if (!world_p)
+      {
+      UE_LOG(LogSkookum, Error, TEXT("Unable to load map '%s'."), *map_name);
+      return nullptr;
+      }
+
+    // Initialized as a game world like the engine does when it loads a map
+    world_p->WorldType = EWorldType::Game;
+    world_p->AddToRoot();
+    world_p->InitWorld();
+    world_p->UpdateWorldComponents(true, false);
+    }
+
+  FWorldContext & world_context = GEngine->CreateNewWorldContext(EWorldType::Game);
+  world_context.SetCurrentWorld(world_p);
+  world_p->InitializeActorsForPlay(FURL(map_name.IsEmpty() ? nullptr : *map_name));
+  world_p->BeginPlay();
+
+  return world_p;
+  }
+
+//---------------------------------------------------------------------------------------
+void USkookumScriptRunCommandlet::destroy_world(UWorld * world_p) const
+  {
+  GEngine->DestroyWorldContext(world_p);
+  world_p->DestroyWorld(false);
+  world_p->RemoveFromRoot();
+  }
+
+//---------------------------------------------------------------------------------------
+// Writes frame timing and process memory of a run as JSON
+bool USkookumScriptRunCommandlet::write_report(const FString & report_path, const TArray<double> & frame_seconds, double delta, double wall_seconds) const
+  {
+  double total_seconds = 0.0;
+  double max_seconds = 0.0;
+  for (double seconds : frame_seconds)
+    {
+    total_seconds += seconds;
+    max_seconds = FMath::Max(max_seconds, seconds);
+    }
+
+  FPlatformMemoryStats memory_stats = FPlatformMemory::GetStats();
+
+  FString report;
+  TSharedRef<TJsonWriter<>> writer_p = TJsonWriterFactory<>::Create(&report);
+  writer_p->WriteObjectStart();
+  writer_p->WriteValue(TEXT("frames"), frame_seconds.Num());
+  writer_p->WriteValue(TEXT("delta"), delta);
+  writer_p->WriteValue(TEXT("wall_seconds"), wall_seconds);
+  writer_p->WriteValue(TEXT("frame_ms_mean"), frame_seconds.Num() ? (total_seconds * 1000.0) / frame_seconds.Num() : 0.0);
+  writer_p->WriteValue(TEXT("frame_ms_max"), max_seconds * 1000.0);
+  writer_p->WriteValue(TEXT("used_physical_bytes"), int64(memory_stats.UsedPhysical));
+  writer_p->WriteValue(TEXT("peak_used_physical_bytes"), int64(memory_stats.PeakUsedPhysical));
+
+  const SkUEDemandLoadManager::Stats & demand_stats = SkUEDemandLoadManager::get()->get_stats();
+  writer_p->WriteValue(TEXT("demand_loads"), int64(demand_stats.m_loads));
+  writer_p->WriteValue(TEXT("demand_reloads"), int64(demand_stats.m_reloads));
+  writer_p->WriteValue(TEXT("demand_evictions"), int64(demand_stats.m_evictions));
+  writer_p->WriteValue(TEXT("demand_bytes_loaded"), int64(demand_stats.m_bytes_loaded));
+  writer_p->WriteObjectEnd();
+  writer_p->Close();
+
+  return FFileHelper::SaveStringToFile(report, *report_path);
+  }
@@ -0,0 +1,84 @@
+//=======================================================================================
+// Copyright (c) 2001-2017 Agog Labs Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=======================================================================================
+
+//=======================================================================================
+// SkookumScript Plugin for Unreal Engine 4
+//
+// Commandlet running the startup class headless with a fixed sim delta
+//=======================================================================================
+
+#pragma once
+
+//=======================================================================================
+// Includes
+//=======================================================================================
+
+#include "Commandlets/Commandlet.h"
+
+#include "SkookumScriptRunCommandlet.generated.h"
+
+//=======================================================================================
+// Global Structures
+//=======================================================================================
+
+class UWorld;
+
+//---------------------------------------------------------------------------------------
+// Runs the compiled scripts without a viewport, e.g. on build machines without a GPU:
+//
+//   UE4Editor-Cmd <Project> -run=SkookumScriptRun -nullrhi [-frames=600] [-delta=0.0333]
+//     [-coroutine=_name] [-report=<path.json>] [-scriptprofile=<base path>]
+//     [-replay=<recording>] [-evictevery=N]
+//
+// A transient game world (or for replays the recorded map) is created so the startup
+// class is instantiated as the master mind exactly like in a game session, then the
+// world is ticked `frames` times with a fixed `delta` so runs are reproducible. If `coroutine` is given it is invoked on the
+// master mind and the run ends early as soon as the master mind goes idle. Frame timing
+// and memory are written to `report` as JSON for trend tracking. With `scriptprofile` the
+// script profiler records the run and exports <base path>.json/.csv. With `replay` a
+// session recorded with `-SkRecord=<recording>` drives the script instead - its calls,
+// events and sim time in the recorded maps - until the recording is exhausted or
+// `frames` is reached. A replay that reaches the end of the recording is checked against
+// its recorded counts. With `evictevery` all demand-loaded class groups that are not
+// locked are evicted every N frames to soak test evicting and reloading them - the load
+// counts are logged and added to the report.
+//
+// Returns 0 on success and 1 if the compiled binaries are not loaded, gameplay does not
+// initialize with the game world, the coroutine is unknown, or the recording cannot be
+// read, its map cannot be loaded or its replay diverged.
+UCLASS()
+class USkookumScriptRunCommandlet : public UCommandlet
+  {
+
+    GENERATED_UCLASS_BODY()
+
+  public:
+
+  // Methods
+
+    // Overridden from UCommandlet
+
+    virtual int32 Main(const FString & params) override;
+
+  protected:
+
+  // Internal Methods
+
+    UWorld * create_world(const FString & map_name) const;
+    void     destroy_world(UWorld * world_p) const;
+    bool     write_report(const FString & report_path, const TArray<double> & frame_seconds, double delta, double wall_seconds) const;
+
+  };
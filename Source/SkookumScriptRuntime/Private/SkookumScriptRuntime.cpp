@@ -21,11 +21,21 @@
 //=======================================================================================
 
 #include "ISkookumScriptRuntime.h"
+#include "Bindings/SkUEAllocationTracer.hpp"
 #include "Bindings/SkUEBindings.hpp"
 #include "Bindings/SkUEClassBinding.hpp"
+#include "Bindings/SkUECostAttribution.hpp"
+#include "Bindings/SkUEHeatMap.hpp"
+#include "Bindings/SkUEMemoryTelemetry.hpp"
+#include "Bindings/SkUEPoolProfile.hpp"
+#include "Bindings/SkUEScriptSampler.hpp"
 #include "Bindings/SkUERuntime.hpp"
 #include "Bindings/SkUERemote.hpp"
+#include "Bindings/SkUEMemberLookup.hpp"
 #include "Bindings/SkUEReflectionManager.hpp"
+#include "Bindings/SkUEScriptProfiler.hpp"
+#include "Bindings/SkUEScriptReplay.hpp"
+#include "Bindings/SkUEStartupProfiler.hpp"
 #include "Bindings/SkUESymbol.hpp"
 #include "Bindings/SkUEUtils.hpp"
 #include "Bindings/Engine/SkUEName.hpp"
@@ -71,6 +81,8 @@ class FAppInfo : public AAppInfoCore, public SkAppInfo
 
     // AAppInfoCore implementation
 
+    virtual uint32_t           get_pool_init_string_ref() const override;
+    virtual uint32_t           get_pool_init_symbol_ref() const override;
     virtual void *             malloc(size_t size, const char * debug_name_p) override;
     virtual void               free(void * mem_p) override;
     virtual uint32_t           request_byte_size(uint32_t size_requested) override;
@@ -82,6 +94,10 @@ class FAppInfo : public AAppInfoCore, public SkAppInfo
 
     // SkAppInfo implementation
 
+    virtual uint32_t           get_pool_init_instance() const override;
+    virtual uint32_t           get_pool_init_data_instance() const override;
+    virtual uint32_t           get_pool_init_iexpr() const override;
+    virtual uint32_t           get_pool_init_icoroutine() const override;
     virtual bool               use_builtin_actor() const override;
     virtual ASymbol            get_custom_actor_class_name() const override;
     virtual void               bind_name_construct(SkBindName * bind_name_p, const AString & value) const override;
@@ -240,15 +256,47 @@ class FSkookumScriptRuntime : public ISkookumScriptRuntime
     FDelegateHandle                 m_game_tick_handle;
     TMap<UWorld *, FDelegateHandle> m_editor_tick_handles;
 
+    // Startup profile report - written once the first game world is initialized
+    FString                 m_startup_profile_report_path;
+    FString                 m_startup_profile_baseline_path;
+    float                   m_startup_profile_max_regression_pct;
+    bool                    m_startup_profile_fail_on_regression;
+
+    // If to write the pool peaks of this session on shutdown - see SkUEPoolProfile
+    bool                    m_pool_profile_record;
+
+    // If -SkRecord was checked already - a recording spans level transitions
+    bool                    m_is_record_checked;
+
     // Settings
 
     static TCHAR const * const ms_ini_section_name_p;
     static TCHAR const * const ms_ini_key_last_connected_to_ide_p;
+    static TCHAR const * const ms_ini_key_cycle_collector_enabled_p;
+    static TCHAR const * const ms_ini_key_cycle_collector_time_slice_p;
+    static TCHAR const * const ms_ini_key_deferred_release_enabled_p;
+    static TCHAR const * const ms_ini_key_deferred_release_max_per_frame_p;
+    static TCHAR const * const ms_ini_key_demand_load_budget_p;
+    static TCHAR const * const ms_ini_key_startup_profile_report_p;
+    static TCHAR const * const ms_ini_key_startup_profile_baseline_p;
+    static TCHAR const * const ms_ini_key_startup_profile_max_regression_p;
+    static TCHAR const * const ms_ini_key_startup_profile_fail_on_regression_p;
+    static TCHAR const * const ms_ini_key_pool_profile_record_p;
 
   };
 
 TCHAR const * const FSkookumScriptRuntime::ms_ini_section_name_p = TEXT("SkookumScriptRuntime");
 TCHAR const * const FSkookumScriptRuntime::ms_ini_key_last_connected_to_ide_p = TEXT("LastConnectedToIDE");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_cycle_collector_enabled_p = TEXT("CycleCollectorEnabled");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_cycle_collector_time_slice_p = TEXT("CycleCollectorTimeSliceMs");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_deferred_release_enabled_p = TEXT("DeferredReleaseEnabled");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_deferred_release_max_per_frame_p = TEXT("DeferredReleaseMaxPerFrame");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_demand_load_budget_p = TEXT("DemandLoadBudgetKB");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_startup_profile_report_p = TEXT("StartupProfileReport");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_startup_profile_baseline_p = TEXT("StartupProfileBaseline");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_startup_profile_max_regression_p = TEXT("StartupProfileMaxRegressionPct");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_startup_profile_fail_on_regression_p = TEXT("StartupProfileFailOnRegression");
+TCHAR const * const FSkookumScriptRuntime::ms_ini_key_pool_profile_record_p = TEXT("PoolProfileRecord");
 
 //---------------------------------------------------------------------------------------
 // Simple error dialog until more sophisticated one in place.
@@ -378,6 +426,9 @@ DEFINE_LOG_CATEGORY(LogSkookum);
 
 FAppInfo::FAppInfo()
   {
+  // Pool sizes are needed as soon as AgogCore initializes
+  SkUEPoolProfile::load(SkUEPoolProfile::get_profile_path());
+
   AgogCore::initialize(this);
   SkookumScript::set_app_info(this);
   SkUESymbol::initialize();
@@ -394,8 +445,25 @@ FAppInfo::~FAppInfo()
 
 //---------------------------------------------------------------------------------------
 
+uint32_t FAppInfo::get_pool_init_string_ref() const
+  {
+  return SkUEPoolProfile::get_init_size(TEXT("AStringRef"), AAppInfoCore::get_pool_init_string_ref());
+  }
+
+//---------------------------------------------------------------------------------------
+
+uint32_t FAppInfo::get_pool_init_symbol_ref() const
+  {
+  return SkUEPoolProfile::get_init_size(TEXT("ASymbolRef"), AAppInfoCore::get_pool_init_symbol_ref());
+  }
+
+//---------------------------------------------------------------------------------------
+
 void * FAppInfo::malloc(size_t size, const char * debug_name_p)
   {
+  SkUEStartupProfiler::on_alloc(size);
+  SkUECostAttribution::on_alloc(size);
+  SkUEAllocationTracer::on_alloc(size, debug_name_p);
   return size ? FMemory::Malloc(size, 16) : nullptr; // $Revisit - MBreyer Make alignment controllable by caller
   }
 
@@ -472,6 +540,34 @@ void FAppInfo::on_error_quit()
 
 //---------------------------------------------------------------------------------------
 
+uint32_t FAppInfo::get_pool_init_instance() const
+  {
+  return SkUEPoolProfile::get_init_size(TEXT("SkInstance"), SkAppInfo::get_pool_init_instance());
+  }
+
+//---------------------------------------------------------------------------------------
+
+uint32_t FAppInfo::get_pool_init_data_instance() const
+  {
+  return SkUEPoolProfile::get_init_size(TEXT("SkDataInstance"), SkAppInfo::get_pool_init_data_instance());
+  }
+
+//---------------------------------------------------------------------------------------
+
+uint32_t FAppInfo::get_pool_init_iexpr() const
+  {
+  return SkUEPoolProfile::get_init_size(TEXT("SkInvokedExpression"), SkAppInfo::get_pool_init_iexpr());
+  }
+
+//---------------------------------------------------------------------------------------
+
+uint32_t FAppInfo::get_pool_init_icoroutine() const
+  {
+  return SkUEPoolProfile::get_init_size(TEXT("SkInvokedCoroutine"), SkAppInfo::get_pool_init_icoroutine());
+  }
+
+//---------------------------------------------------------------------------------------
+
 bool FAppInfo::use_builtin_actor() const
   {
   return false;
@@ -565,6 +661,10 @@ FSkookumScriptRuntime::FSkookumScriptRuntime()
   , m_game_world_p(nullptr)
   , m_editor_world_p(nullptr)
   , m_num_game_worlds(0)
+  , m_startup_profile_max_regression_pct(20.0f)
+  , m_startup_profile_fail_on_regression(false)
+  , m_pool_profile_record(false)
+  , m_is_record_checked(false)
   {
   }
 
@@ -595,6 +695,8 @@ void FSkookumScriptRuntime::StartupModule()
       }
   #endif
 
+  SkUEStartupProfiler::Scope phase(TEXT("StartupModule"));
+
   A_DPRINT("Starting up SkookumScript plug-in modules\n");
 
   load_ini_settings();
@@ -659,9 +761,41 @@ void FSkookumScriptRuntime::on_world_init_pre(UWorld * world_p, const UWorld::In
       if (is_skookum_initialized())
         {
         SkUEClassBindingHelper::set_world(world_p);
+
+        // Record the session from the very start so the recording can be replayed - once
+        // started, the recording continues across level transitions
+        if (m_is_record_checked)
+          {
+          SkUEScriptReplay::on_world_changed(world_p);
+          }
+        else
+          {
+          FString record_path;
+          if (FParse::Value(FCommandLine::Get(), TEXT("SkRecord="), record_path))
+            {
+            SkUEScriptReplay::start_recording(record_path);
+            }
+          m_is_record_checked = true;
+          }
+
+        SkUEStartupProfiler::Scope phase(TEXT("SkookumScript::initialize_gameplay"));
         SkookumScript::initialize_gameplay();
         }
       m_game_tick_handle = world_p->OnTickDispatch().AddRaw(this, &FSkookumScriptRuntime::tick_game);
+
+      // Startup is complete now
+      if (SkUEStartupProfiler::is_recording()
+        && !SkUEStartupProfiler::finish(m_startup_profile_report_path, m_startup_profile_baseline_path, m_startup_profile_max_regression_pct))
+        {
+        if (m_startup_profile_fail_on_regression)
+          {
+          UE_LOG(LogSkookum, Fatal, TEXT("SkookumScript startup regressed compared to baseline '%s' - see log for details."), *m_startup_profile_baseline_path);
+          }
+        else
+          {
+          UE_LOG(LogSkookum, Warning, TEXT("SkookumScript startup regressed compared to baseline '%s' - see log for details."), *m_startup_profile_baseline_path);
+          }
+        }
       }
     }
 #if WITH_EDITOR
@@ -725,6 +859,8 @@ void FSkookumScriptRuntime::on_world_cleanup(UWorld * world_p, bool session_ende
           "SkookumScript resetting session...\n"
           "  cleaning up...\n");
         SkookumScript::deinitialize_gameplay();
+        m_runtime.get_cycle_collector()->collect_all();
+        m_runtime.get_release_queue()->flush();
         SkookumScript::deinitialize_sim();
         SkookumScript::initialize_sim();
         A_DPRINT("  ...done!\n\n");
@@ -769,6 +905,15 @@ void FSkookumScriptRuntime::ShutdownModule()
   // So quick fix is to just not print during shutdown
   //A_DPRINT(A_SOURCE_STR " Shutting down SkookumScript plug-in modules\n");
 
+  // Pool peaks of this session while the pools are still around
+  if (m_pool_profile_record)
+    {
+    SkUEPoolProfile::save_session(SkUEPoolProfile::get_session_path());
+    }
+
+  // Write out a recording that is still in progress
+  SkUEScriptReplay::stop_recording();
+
   //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
   // Clean up SkookumScript
   m_runtime.shutdown();
@@ -833,6 +978,44 @@ void FSkookumScriptRuntime::load_ini_settings()
     GConfig->GetString(ms_ini_section_name_p, ms_ini_key_last_connected_to_ide_p, last_connected_to_ide, ini_file_path);
     m_remote_client.set_last_connected_to_ide(!last_connected_to_ide.IsEmpty() && last_connected_to_ide[0] == '1');
   #endif
+
+  SkUECycleCollector * cycle_collector_p = m_runtime.get_cycle_collector();
+  bool cycle_collector_enabled = cycle_collector_p->is_enabled();
+  float cycle_collector_time_slice_ms = float(cycle_collector_p->get_time_slice_ms());
+  GConfig->GetBool(ms_ini_section_name_p, ms_ini_key_cycle_collector_enabled_p, cycle_collector_enabled, ini_file_path);
+  GConfig->GetFloat(ms_ini_section_name_p, ms_ini_key_cycle_collector_time_slice_p, cycle_collector_time_slice_ms, ini_file_path);
+  cycle_collector_p->set_enabled(cycle_collector_enabled);
+  cycle_collector_p->set_time_slice_ms(cycle_collector_time_slice_ms);
+
+  SkUEReleaseQueue * release_queue_p = m_runtime.get_release_queue();
+  bool deferred_release_enabled = release_queue_p->is_enabled();
+  int32 deferred_release_max_per_frame = int32(release_queue_p->get_max_per_frame());
+  GConfig->GetBool(ms_ini_section_name_p, ms_ini_key_deferred_release_enabled_p, deferred_release_enabled, ini_file_path);
+  GConfig->GetInt(ms_ini_section_name_p, ms_ini_key_deferred_release_max_per_frame_p, deferred_release_max_per_frame, ini_file_path);
+  release_queue_p->set_enabled(deferred_release_enabled);
+  release_queue_p->set_max_per_frame(uint32_t(FMath::Max(deferred_release_max_per_frame, 1)));
+
+  SkUEDemandLoadManager * demand_load_manager_p = m_runtime.get_demand_load_manager();
+  int32 demand_load_budget_kb = int32(demand_load_manager_p->get_budget_bytes() / 1024u);
+  GConfig->GetInt(ms_ini_section_name_p, ms_ini_key_demand_load_budget_p, demand_load_budget_kb, ini_file_path);
+  demand_load_manager_p->set_budget_bytes(uint32_t(FMath::Max(demand_load_budget_kb, 0)) * 1024u);
+
+  // Relative report paths are relative to the project's Saved folder
+  GConfig->GetString(ms_ini_section_name_p, ms_ini_key_startup_profile_report_p, m_startup_profile_report_path, ini_file_path);
+  GConfig->GetString(ms_ini_section_name_p, ms_ini_key_startup_profile_baseline_p, m_startup_profile_baseline_path, ini_file_path);
+  GConfig->GetFloat(ms_ini_section_name_p, ms_ini_key_startup_profile_max_regression_p, m_startup_profile_max_regression_pct, ini_file_path);
+  GConfig->GetBool(ms_ini_section_name_p, ms_ini_key_startup_profile_fail_on_regression_p, m_startup_profile_fail_on_regression, ini_file_path);
+  if (!m_startup_profile_report_path.IsEmpty() && FPaths::IsRelative(m_startup_profile_report_path))
+    {
+    m_startup_profile_report_path = FPaths::ProjectSavedDir() / m_startup_profile_report_path;
+    }
+  if (!m_startup_profile_baseline_path.IsEmpty() && FPaths::IsRelative(m_startup_profile_baseline_path))
+    {
+    m_startup_profile_baseline_path = FPaths::ProjectSavedDir() / m_startup_profile_baseline_path;
+    }
+
+  GConfig->GetBool(ms_ini_section_name_p, ms_ini_key_pool_profile_record_p, m_pool_profile_record, ini_file_path);
+  m_pool_profile_record |= FParse::Param(FCommandLine::Get(), TEXT("SkPoolProfileRecord"));
   }
 
 //---------------------------------------------------------------------------------------
@@ -1039,7 +1222,38 @@ void FSkookumScriptRuntime::tick_game(float deltaTime)
   #endif
       {
       SCOPE_CYCLE_COUNTER(STAT_SkookumScriptTime);
-      m_runtime.update(deltaTime);
+      {
+      SkUEScriptProfiler::UpdateScope profile;
+      SkUECostAttribution::UpdateScope cost;
+      SkUEScriptSampler::UpdateScope sampled;
+      if (!SkUEScriptReplay::replay_update())
+        {
+        m_runtime.update(deltaTime);
+        }
+      SkUEScriptReplay::record_update();
+      }
+
+      // Count the call sites coroutines are waiting on
+      SkUEHeatMap::sample_coroutines();
+
+      // Aggregate call stacks sampled during the update
+      SkUEScriptSampler::drain();
+
+      // Attribute the update to the coroutines and receivers sampled during it
+      SkUEScriptProfiler::distribute_updates();
+      SkUECostAttribution::publish();
+
+      // Record pool and memory usage of this frame
+      SkUEMemoryTelemetry::sample();
+
+      // Look for garbage cycles within the configured time slice
+      m_runtime.get_cycle_collector()->update();
+
+      // Spread out destruction of released instances
+      m_runtime.get_release_queue()->update();
+
+      // Unload least recently used demand-loaded class groups when over budget
+      m_runtime.get_demand_load_manager()->update();
       }
   }
 
@@ -1087,6 +1301,7 @@ void FSkookumScriptRuntime::tick_remote()
       // $Revisit - CReis This is probably a hack. The remote client update should probably
       // live somewhere other than a tick method such as its own thread.
       m_remote_client.process_incoming();
+      m_remote_client.update_memory_stream();
 
       // Re-load compiled binaries?
       // If the game is currently running, delay until it's not
@@ -1251,7 +1466,7 @@ bool FSkookumScriptRuntime::has_skookum_default_constructor(UClass * class_p) co
   SkClass * sk_class_p = SkUEClassBindingHelper::get_sk_class_from_ue_class(class_p);
   if (sk_class_p)
     {
-    return (sk_class_p->find_instance_method_inherited(ASymbolX_ctor) != nullptr);
+    return (SkUEMemberLookup::find_instance_method_inherited(sk_class_p, ASymbolX_ctor) != nullptr);
     }
 
   return false;
@@ -1266,7 +1481,7 @@ bool FSkookumScriptRuntime::has_skookum_destructor(UClass * class_p) const
   SkClass * sk_class_p = SkUEClassBindingHelper::get_sk_class_from_ue_class(class_p);
   if (sk_class_p)
     {
-    return (sk_class_p->find_instance_method_inherited(ASymbolX_dtor) != nullptr);
+    return (SkUEMemberLookup::find_instance_method_inherited(sk_class_p, ASymbolX_dtor) != nullptr);
     }
 
   return false;
@@ -91,6 +91,7 @@ class SKOOKUMSCRIPTRUNTIME_API USkookumScriptListener : public UObject
   protected:
 
     friend class AObjReusePool<EventInfo>;
+    friend class SkUEScriptReplay;  // Replays recorded events
 
   // Internal Methods
 
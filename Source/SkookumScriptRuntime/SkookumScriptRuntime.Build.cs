@@ -63,6 +63,7 @@ namespace UnrealBuildTool.Rules
             "NetworkReplayStreaming",
             "Projects",
             "SourceControl",
+            "Json",
           }
         );
 